@@ -56,6 +56,16 @@ double Buttons::LastReleased(ButtonId id) const
     return buttonUpTimes_[i];
 }
 
+uint32_t Buttons::Held() const
+{
+    return buttons_;
+}
+
+void Buttons::Hold(uint32_t buttons)
+{
+    buttons_ = buttons;
+}
+
 void Buttons::UpdateButton(bool isPressOrRepeat, uint32_t bit)
 {
     if (isPressOrRepeat)
@@ -36,6 +36,12 @@ public:
 
     double LastReleased(ButtonId id) const;
 
+    // The buttons that are held, one bit per ButtonId.
+    uint32_t Held() const;
+
+    // Replaces the buttons that are held, e.g., to play back a recording. The change is seen on the next Update().
+    void Hold(uint32_t buttons);
+
     void Update(double t);
 
     void OnKeyEvent(GLFWwindow* window, int key, int scancode, int action, int mode);
@@ -54,8 +60,8 @@ private:
     ButtonBits buttons_{0};
     ButtonBits buttonDowns_{0};
     ButtonBits buttonUps_{0};
-    std::array<double, numButtons> buttonDownTimes_;
-    std::array<double, numButtons> buttonUpTimes_;
+    std::array<double, numButtons> buttonDownTimes_{};
+    std::array<double, numButtons> buttonUpTimes_{};
     bool wasLeftActivated_{};
     bool wasRightActivated_{};
     bool wasUpActivated_{};
@@ -0,0 +1,205 @@
+#include "CpuPlayer.h"
+
+namespace
+{
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    // Without threads the player has to think on the update thread, so it only ever looks one move ahead.
+    constexpr bool hasWorker = false;
+#else
+    constexpr bool hasWorker = true;
+#endif
+
+    uint32_t Bit(ButtonId id)
+    {
+        return uint32_t{1} << static_cast<uint32_t>(id);
+    }
+
+    const uint64_t validBit = uint64_t{1} << 63;
+    const uint64_t swapBit = uint64_t{1} << 62;
+} // namespace
+
+CpuPlayer::CpuPlayer(Skill skill)
+    : budget_{BudgetFor(skill)}
+{
+    if (hasWorker)
+    {
+        thread_ = std::thread([this] { Think(); });
+    }
+}
+
+CpuPlayer::~CpuPlayer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    interrupt_.store(true, std::memory_order_relaxed);
+    wake_.notify_one();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+CpuPlayer::Budget CpuPlayer::BudgetFor(Skill skill)
+{
+    switch (skill)
+    {
+    case Skill::Easy:
+        return Budget{2, 4, 12, 40};
+    case Skill::Normal:
+        return Budget{3, 16, 8, 20};
+    case Skill::Hard:
+    default:
+        return Budget{5, 48, 5, 6};
+    }
+}
+
+uint64_t CpuPlayer::Pack(const Search::Move& move)
+{
+    // The tick says which position the move was found from, rather than when it is to be played.
+    return validBit | (move.swap ? swapBit : 0) | (uint64_t{move.x} << 40) | (uint64_t{move.y} << 32) | move.tick;
+}
+
+bool CpuPlayer::Unpack(uint64_t packed, Search::Move& move)
+{
+    move.swap = (packed & swapBit) != 0;
+    move.x = static_cast<uint8_t>(packed >> 40);
+    move.y = static_cast<uint8_t>(packed >> 32);
+    move.tick = static_cast<uint32_t>(packed);
+    return (packed & validBit) != 0;
+}
+
+void CpuPlayer::Reset()
+{
+    move_.store(0, std::memory_order_relaxed);
+    interrupt_.store(true, std::memory_order_relaxed);
+    wait_ = budget_.reactionTicks;
+    pressed_ = false;
+    swappedAt_ = 0;
+    lastTick_ = 0;
+}
+
+uint32_t CpuPlayer::Update(const PitGame::Snapshot& position)
+{
+    // A new game has started, so the old plan is no use.
+    if (position.ticks < lastTick_)
+    {
+        Reset();
+    }
+    lastTick_ = position.ticks;
+
+    if (hasWorker)
+    {
+        Post(position);
+    }
+
+    // Let go of the last button, so that the next press is seen as a press.
+    if (pressed_)
+    {
+        pressed_ = false;
+        return 0;
+    }
+    if (wait_ > 0)
+    {
+        --wait_;
+        return 0;
+    }
+
+    Search::Move move;
+    if (!hasWorker && !Unpack(move_.load(std::memory_order_acquire), move))
+    {
+        Publish(position);
+    }
+    if (!Unpack(move_.load(std::memory_order_acquire), move) || move.tick < swappedAt_ || !move.swap)
+    {
+        return 0;
+    }
+
+    pressed_ = true;
+    wait_ = budget_.ticksPerPress > 2 ? budget_.ticksPerPress - 2 : 0;
+    if (move.x < position.cursorX)
+    {
+        return Bit(ButtonId::left);
+    }
+    if (move.x > position.cursorX)
+    {
+        return Bit(ButtonId::right);
+    }
+    if (move.y < position.cursorY)
+    {
+        return Bit(ButtonId::up);
+    }
+    if (move.y > position.cursorY)
+    {
+        return Bit(ButtonId::down);
+    }
+
+    // The swap happens on the next update, so only moves found from positions after that take it into account. Take
+    // a moment before going on to the next one.
+    swappedAt_ = position.ticks + 1;
+    wait_ += budget_.reactionTicks;
+    move_.store(0, std::memory_order_relaxed);
+    interrupt_.store(true, std::memory_order_relaxed);
+    return Bit(ButtonId::a);
+}
+
+void CpuPlayer::Post(const PitGame::Snapshot& position)
+{
+    // If the worker is busy taking the last position then it can have this one next time.
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock())
+    {
+        return;
+    }
+    position_ = position;
+    hasPosition_ = true;
+    lock.unlock();
+    wake_.notify_one();
+}
+
+void CpuPlayer::Think()
+{
+    for (;;)
+    {
+        PitGame::Snapshot position;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stopping_ || hasPosition_; });
+            if (stopping_)
+            {
+                return;
+            }
+            position = position_;
+            hasPosition_ = false;
+        }
+        interrupt_.store(false, std::memory_order_relaxed);
+        Publish(position);
+    }
+}
+
+void CpuPlayer::Publish(const PitGame::Snapshot& position)
+{
+    // Search deeper and deeper for as long as the budget allows, publishing the best move after each search, so that
+    // there's always something to play however soon the update thread wants it.
+    PitGame game;
+    game.Restore(position);
+    Search::Options options;
+    options.beamWidth = budget_.beamWidth;
+    options.ticksPerPress = budget_.ticksPerPress;
+    options.stop = hasWorker ? &interrupt_ : nullptr;
+    options.table = &table_;
+    const size_t maxDepth = hasWorker ? budget_.depth : 1;
+    for (size_t depth = 1; depth <= maxDepth; depth++)
+    {
+        options.depth = depth;
+        const Search::Result result = Search::Run(game, options);
+        if (result.line.empty() || (hasWorker && interrupt_.load(std::memory_order_relaxed)))
+        {
+            return;
+        }
+        Search::Move move = result.line.front();
+        move.tick = position.ticks;
+        move_.store(Pack(move), std::memory_order_release);
+    }
+}
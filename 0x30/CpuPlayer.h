@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Buttons.h"
+
+#include "pit_core/PitGame.h"
+#include "pit_core/Search.h"
+#include "pit_core/TranspositionTable.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// A computer player that presses the same buttons as a person would.
+//
+// It thinks on a worker thread. Each time it finishes thinking it picks up the latest position, then searches deeper
+// and deeper from it, up to the limit for its skill, publishing the first move of the best line after each search. The
+// update thread only ever offers it positions and reads the latest move, so it never waits for the worker. How hard
+// the player is depends on how far it looks ahead, how quickly it presses buttons, and how long it pauses after a
+// swap.
+class CpuPlayer
+{
+public:
+    enum class Skill
+    {
+        Easy,
+        Normal,
+        Hard
+    };
+
+    explicit CpuPlayer(Skill skill);
+    ~CpuPlayer();
+
+    CpuPlayer(const CpuPlayer&) = delete;
+    CpuPlayer& operator=(const CpuPlayer&) = delete;
+
+    // Gives the player the position after the last update, and returns the buttons that it holds for the next one, one
+    // bit per ButtonId.
+    uint32_t Update(const PitGame::Snapshot& position);
+
+    // Forgets the current plan, e.g., when a new game starts.
+    void Reset();
+
+private:
+    // How hard the player thinks, and how quickly it acts on what it thinks.
+    struct Budget
+    {
+        size_t depth;           // The deepest that it searches.
+        size_t beamWidth;       // The number of positions that it keeps at each step.
+        uint32_t ticksPerPress; // The number of updates between its button presses.
+        uint32_t reactionTicks; // The number of updates that it waits after a swap before it starts on the next one.
+    };
+
+    static Budget BudgetFor(Skill skill);
+
+    // A move packed into a single word so that it can be published atomically.
+    static uint64_t Pack(const Search::Move& move);
+    static bool Unpack(uint64_t packed, Search::Move& move);
+
+    void Post(const PitGame::Snapshot& position);
+    void Think();
+    void Publish(const PitGame::Snapshot& position);
+
+    Budget budget_;
+    TranspositionTable table_{12};// Only used by whichever thread is thinking.
+    uint32_t wait_{0};     // Updates until the next press.
+    bool pressed_{false};  // Whether a button was pressed on the last update, so it has to be released.
+    uint32_t swappedAt_{0};// The first tick whose position includes the last swap.
+    uint32_t lastTick_{0};
+
+    // Shared with the worker.
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    PitGame::Snapshot position_;  // The latest position, guarded by mutex_.
+    bool hasPosition_{false};     // Whether position_ is newer than the one being searched, guarded by mutex_.
+    bool stopping_{false};        // Guarded by mutex_.
+    std::atomic<bool> interrupt_{false};// Tells the search that its position is out of date, e.g., after a swap.
+    std::atomic<uint64_t> move_{0};     // The best move so far, packed.
+    std::thread thread_;
+};
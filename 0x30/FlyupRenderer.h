@@ -1,10 +1,10 @@
 #pragma once
 
 #include "Flyup.h"
-#include "Pit.h"
 #include "Textures.h"
 
 #include "je/Batch.h"
+#include "pit_core/Pit.h"
 
 #include <vector>
 
@@ -8,16 +8,18 @@
 #include "je/Logger.h"
 #include "je/MyTime.h"
 #include "je/QuadHelpers.h"
+#include "pit_core/Difficulty.h"
 
 #include <cmath>
 #include <iomanip>
 #include <sstream>
 
-Menu::Menu(Buttons& buttons, const Progress& progress, je::Batch& batch, Textures& textures)
+Menu::Menu(Buttons& buttons, const Progress& progress, je::Batch& batch, Textures& textures, const std::vector<Puzzle>& puzzles)
     : buttons_ {buttons},
       progress_ {progress},
       batch_ {batch},
       textures_ {textures},
+      puzzles_ {puzzles},
       textRenderer_ {textures.textTiles, batch}
 {
 }
@@ -34,9 +36,27 @@ void Menu::Start(double t)
     }
 }
 
+size_t Menu::MaxSelection() const
+{
+    if (mode_ == Mode::TIMED)
+    {
+        return progress_.MaxLevel();
+    }
+    if (mode_ == Mode::ENDLESS)
+    {
+        return progress_.MaxTimedLevel();
+    }
+    if (mode_ == Mode::PRACTICE)
+    {
+        return progress_.MaxLevel();
+    }
+    return puzzles_.size();
+}
+
 Screens Menu::Update(double /*t*/, double /*dt*/)
 {
-    if (buttons_.JustPressed(ButtonId::a))
+    // There's nothing to play in puzzle mode if the puzzles couldn't be loaded.
+    if (buttons_.JustPressed(ButtonId::a) && MaxSelection() > 0)
     {
         return Screens::Playing;
     }
@@ -46,19 +66,29 @@ Screens Menu::Update(double /*t*/, double /*dt*/)
         return Screens::Quit;
     }
 
-    if (buttons_.JustPressed(ButtonId::left) || buttons_.JustPressed(ButtonId::right))
+    // Right goes from endless to timed to puzzle to practice mode, and left goes back.
+    const bool right = buttons_.JustPressed(ButtonId::right);
+    if (buttons_.JustPressed(ButtonId::left) || right)
     {
         if (mode_ == Mode::ENDLESS)
         {
-            mode_ = Mode::TIMED;
-            currentSelection_ = std::min(currentSelection_, progress_.MaxLevel() - 1);
+            mode_ = right ? Mode::TIMED : Mode::PRACTICE;
         }
         else if (mode_ == Mode::TIMED)
         {
-            mode_ = Mode::ENDLESS;
-            currentSelection_ = std::min(currentSelection_, progress_.MaxTimedLevel() - 1);
+            mode_ = right ? Mode::PUZZLE : Mode::ENDLESS;
         }
-        firstVisibleLevel_ = 0;
+        else if (mode_ == Mode::PUZZLE)
+        {
+            mode_ = right ? Mode::PRACTICE : Mode::TIMED;
+        }
+        else
+        {
+            mode_ = right ? Mode::ENDLESS : Mode::PUZZLE;
+        }
+        const size_t maxSelection = MaxSelection();
+        currentSelection_ = std::min(currentSelection_, maxSelection > 0 ? maxSelection - 1 : 0);
+        firstVisibleLevel_ = currentSelection_ + 1 > static_cast<size_t>(visibleLevels_) ? currentSelection_ + 1 - visibleLevels_ : 0;
     }
 
     if (buttons_.JustPressed(ButtonId::up) && currentSelection_ > 0)
@@ -67,17 +97,7 @@ Screens Menu::Update(double /*t*/, double /*dt*/)
         firstVisibleLevel_ = std::min(currentSelection_, firstVisibleLevel_);
     }
 
-    size_t maxSelection = 0;
-    if (mode_ == Mode::TIMED)
-    {
-        maxSelection = progress_.MaxLevel();
-    }
-    else if (mode_ == Mode::ENDLESS)
-    {
-        maxSelection = progress_.MaxTimedLevel();
-    }
-
-    if (buttons_.JustPressed(ButtonId::down) && currentSelection_ + 1 < maxSelection)
+    if (buttons_.JustPressed(ButtonId::down) && currentSelection_ + 1 < MaxSelection())
     {
         ++currentSelection_;
         if (currentSelection_ >= firstVisibleLevel_ + visibleLevels_)
@@ -144,6 +164,14 @@ void Menu::Draw(double t)
     {
         textRenderer_.DrawCentred(x, y, "Endless fun", Colours::mode);
     }
+    else if (mode_ == Mode::PUZZLE)
+    {
+        textRenderer_.DrawCentred(x, y, "Puzzles", Colours::mode);
+    }
+    else if (mode_ == Mode::PRACTICE)
+    {
+        textRenderer_.DrawCentred(x, y, "Practice", Colours::mode);
+    }
     x = VIRTUAL_WIDTH / 2.0f - 64.0f + 8.0f;
 
     // Draw the level selection cursor.
@@ -203,4 +231,29 @@ void Menu::Draw(double t)
             y += 12.0f;
         }
     }
+    else if (mode_ == Mode::PUZZLE)
+    {
+        // Draw the number of swaps that each puzzle has to be solved in.
+        const size_t lastVisiblePuzzle = std::min(firstVisibleLevel_ + visibleLevels_, puzzles_.size());
+        for (auto i = firstVisibleLevel_; i < lastVisiblePuzzle; i++)
+        {
+            const size_t swaps = puzzles_[i].Swaps();
+            std::stringstream text;
+            text << std::setw(3) << (i + 1) << std::setw(0) << "   " << swaps << (swaps == 1 ? " swap" : " swaps");
+            textRenderer_.DrawLeft(x, y, text.str(), Colours::selectableLevel);
+            y += 12.0f;
+        }
+    }
+    else if (mode_ == Mode::PRACTICE)
+    {
+        // Draw the speed of each level that has been reached.
+        const size_t lastVisibleLevel = std::min(firstVisibleLevel_ + visibleLevels_, MaxSelection());
+        for (auto i = firstVisibleLevel_; i < lastVisibleLevel; i++)
+        {
+            std::stringstream text;
+            text << std::setw(2) << (i + 1) << std::setw(0) << "  speed " << std::setw(2) << Difficulty::SpeedForLevel(i + 1);
+            textRenderer_.DrawLeft(x, y, text.str(), Colours::selectableLevel);
+            y += 12.0f;
+        }
+    }
 }
@@ -7,23 +7,30 @@
 #include "Types.h"
 
 #include "je/Batch.h"
+#include "pit_core/Puzzle.h"
+
+#include <vector>
 
 class Menu
 {
 public:
-    Menu(Buttons& buttons, const Progress& progress, je::Batch& batch, Textures& textures);
+    Menu(Buttons& buttons, const Progress& progress, je::Batch& batch, Textures& textures, const std::vector<Puzzle>& puzzles);
 
     void Start(double t);
     Screens Update(double t, double dt);
     void Draw(double t);
+    // The level, or in puzzle mode the puzzle, counting from 1.
     size_t SelectedLevel() const { return currentSelection_ + 1; }
     Mode SelectedMode() const { return mode_; }
 
 private:
+    size_t MaxSelection() const;
+
     Buttons& buttons_;
     const Progress& progress_;
     je::Batch& batch_;
     Textures& textures_;
+    const std::vector<Puzzle>& puzzles_;
     TextRenderer textRenderer_;
 
     double screenStartTime_{0};
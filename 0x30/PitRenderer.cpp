@@ -1,8 +1,8 @@
 #include "PitRenderer.h"
 
-#include "Pit.h"
 #include "je/Logger.h"
 #include "je/QuadHelpers.h"
+#include "pit_core/Pit.h"
 
 void PitRenderer::Draw(je::Vec2f topLeft, float internalTileScroll, const float bottomRow)
 {
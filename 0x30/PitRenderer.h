@@ -1,8 +1,8 @@
 #pragma once
 
-#include "Pit.h"
 #include "Textures.h"
 #include "je/Batch.h"
+#include "pit_core/Pit.h"
 
 class PitRenderer
 {
@@ -4,33 +4,51 @@
 #include "Colours.h"
 #include "Types.h"
 
+#include "je/AsyncPersistence.h"
 #include "je/Human.h"
 #include "je/Logger.h"
+#include "pit_core/Difficulty.h"
+#include "pit_core/Scoring.h"
 
 #include <algorithm>
-#include <cmath>
 
-const double TIMED_MODE_TIME = 98.0;
-const double ENDLESS_MODE_TIME = 98.0;
+// Everything that affects play is timed in updates rather than seconds, so that a game plays out exactly the same way
+// however quickly it's drawn and wherever it's run.
+const uint64_t UPDATES_PER_SECOND = static_cast<uint64_t>(UPDATE_FPS);
+const uint64_t TIMED_MODE_UPDATES = Difficulty::timedModeUpdates;
+const uint64_t ENDLESS_MODE_UPDATES = Difficulty::endlessModeUpdates;
 
-Playing::Playing(Buttons& buttons, Progress& progress, je::Batch& batch, Textures& textures, Sounds& sounds, std::function<int(int, int)>& rnd)
+namespace
+{
+    double Seconds(uint64_t updates)
+    {
+        return static_cast<double>(updates) / UPDATES_PER_SECOND;
+    }
+} // namespace
+
+Playing::Playing(Buttons& buttons, Progress& progress, je::Batch& batch, Textures& textures, Sounds& sounds, uint64_t seed,
+                 const std::vector<Puzzle>& puzzles)
     : buttons_{buttons},
       progress_{progress},
       batch_{batch},
       textures_{textures},
       sounds_{sounds},
-      pit_{rnd},
+      seeds_{seed},
+      pit_{},
       pitRenderer_{pit_, textures, batch},
       textRenderer_{textures.textTiles, batch},
       timeRenderer_{textRenderer_, "TIME"},
       bestTimeRenderer_{textRenderer_, "BEST"},
       scoreRenderer_{textRenderer_, "SCORE"},
       highScoreRenderer_{textRenderer_, " HIGH"},
+      swapsRenderer_{textRenderer_, "SWAPS"},
       speedRenderer_{textRenderer_},
       flyupRenderer_{textures, batch_},
       mode_{Mode::TIMED},
+      puzzles_{puzzles},
       state_{State::PLAYING}
 {
+    pit_.AttachEvents(&pitEvents_);
 }
 
 void Playing::SetLevel(size_t level)
@@ -39,7 +57,7 @@ void Playing::SetLevel(size_t level)
     progress_.UpdateMaxLevel(level_);
 }
 
-void Playing::SetState(State state, double t)
+void Playing::SetState(State state)
 {
     state_ = state;
     if (state_ == State::GAME_OVER)
@@ -52,33 +70,53 @@ void Playing::SetState(State state, double t)
         {
             progress_.UpdateBestTime(initialLevel_, bestTime_);
         }
+        SaveRecording();
     }
-    stateStartTime_ = t;
+    stateStartTick_ = ticks_;
+    fastScrollAllowed_ = false;
+}
+
+void Playing::SaveRecording()
+{
+    std::ostringstream os;
+    recording_.Save(os);
+    savedRecording_ = os.str();
+    LOG("Recorded " << recording_.Ticks() << " updates in " << savedRecording_.size() << " bytes");
+
+    je::AsyncPersistenceSaver::Save(
+            "replay",
+            savedRecording_.data(),
+            static_cast<int>(savedRecording_.size()),
+            [](auto filename) {
+                LOG("Saved replay to " << filename);
+            },
+            [](auto filename) {
+                LOG("Failed to save replay to " << filename);
+            });
 }
 
 void Playing::SetDifficulty(size_t actualLevel)
 {
     // The scroll rate is based on the level number, but doesn't increase when new blocks are introduced.
     pit_.SetLevel(actualLevel);
-    size_t speedMultiplier = actualLevel - 1;
-    if (actualLevel >= 16)
-    {
-        --speedMultiplier;
-    }
-    if (actualLevel >= 9)
-    {
-        --speedMultiplier;
-    }
-    if (actualLevel >= 4)
-    {
-        --speedMultiplier;
-    }
-    LOG("Level " << actualLevel << ", speed " << speedMultiplier);
-    scrollRate_ = 0.025f + (0.0025f * speedMultiplier);
+    LOG("Level " << actualLevel << ", speed " << Difficulty::SpeedForLevel(actualLevel));
+    scrollRate_ = Difficulty::ScrollRateForLevel(actualLevel);
 }
 
-void Playing::Start(const double t, const size_t level, Mode mode)
+void Playing::Start(const size_t level, Mode mode)
 {
+    Start(level, mode, seeds_.Next64());
+}
+
+void Playing::Start(const size_t level, Mode mode, uint64_t seed)
+{
+    // A recording of a puzzle can't be played back without the puzzles.
+    if (mode == Mode::PUZZLE && puzzles_.empty())
+    {
+        LOG("There are no puzzles to play");
+        mode = Mode::ENDLESS;
+    }
+    recording_ = Recording{seed, static_cast<uint32_t>(level), static_cast<uint8_t>(mode), static_cast<uint16_t>(buttons_.Held()), {}};
     mode_ = mode;
     size_t actualLevel = 1;
     if (mode_ == Mode::TIMED)
@@ -90,38 +128,46 @@ void Playing::Start(const double t, const size_t level, Mode mode)
     else if (mode_ == Mode::ENDLESS)
     {
         initialLevel_ = level;
-        if (level == 1)
-        {
-            actualLevel = 3;
-        }
-        else if (level == 2)
-        {
-            actualLevel = 6;
-        }
-        else if (level == 3)
-        {
-            actualLevel = 9;
-        }
+        actualLevel = Difficulty::EndlessStartingLevel(level);
         SetLevel(level);
         bestTime_ = progress_.BestTime(level_);
     }
-    pit_.Reset(actualLevel);
-    SetState(State::PLAYING, t);
+    else if (mode_ == Mode::PRACTICE)
+    {
+        // Practice stays at the speed that it starts at, and doesn't count towards anything.
+        actualLevel = std::clamp(level, size_t{1}, numLevels_);
+        level_ = actualLevel;
+    }
+    pit_.Reset(actualLevel, seed);
+    pit_.SetGarbage(mode_ == Mode::ENDLESS);
+    if (mode_ == Mode::PUZZLE)
+    {
+        level_ = std::clamp(level, size_t{1}, puzzles_.size());
+        const Puzzle& puzzle = puzzles_[level_ - 1];
+        puzzle.SetUp(pit_);
+        actualLevel = puzzle.level;
+        swapsLeft_ = puzzle.Swaps();
+        puzzleSolved_ = false;
+    }
+    pitEvents_.Drain([](const Pit::Event&) {});// Forget anything left over from the last game.
+    SetState(State::PLAYING);
     score_ = 0;
     if (mode_ == Mode::TIMED)
     {
-        remainingTime_ = TIMED_MODE_TIME;
+        remainingTicks_ = TIMED_MODE_UPDATES;
     }
     else if (mode_ == Mode::ENDLESS)
     {
-        timeToNextLevelChange_ = ENDLESS_MODE_TIME;
+        ticksToNextLevelChange_ = ENDLESS_MODE_UPDATES;
     }
-    elapsedTime_ = 0.0;
-    lastTime_ = t;
+    elapsedTicks_ = 0;
     lastPlayed_ = actualLevel;
 
     SetDifficulty(actualLevel);
 
+    // A recording only says how the game started, so nothing can be carried over from the last game, not even how far
+    // the pit had scrolled. This also lines puzzles, which don't scroll, up with the screen.
+    internalTileScroll_ = 0;
     cursorTileX_ = (Pit::cols / 2) - 1;
     cursorTileY_ = Pit::rows / 2;
     flyupRenderer_.Reset();
@@ -129,74 +175,142 @@ void Playing::Start(const double t, const size_t level, Mode mode)
     {
         musicSource_.Play(sounds_.musicMinuteWaltz);
     }
-    else if (mode_ == Mode::ENDLESS)
+    else if (mode_ == Mode::ENDLESS || mode_ == Mode::PUZZLE || mode_ == Mode::PRACTICE)
     {
         musicSource_.Play(sounds_.musicGymnopedie);
     }
+    history_.Clear();
+    if (mode_ == Mode::PRACTICE)
+    {
+        history_.Push({Position(), elapsedTicks_});
+    }
 }
 
-void Playing::UpdateScore()
+PitGame::Snapshot Playing::Position() const
 {
-    const auto& runs = pit_.Runs();
-    if (runs.size() > 0)
-    {
-        auto multiplier = runs.size();
-        LOG("Run info");
-        int n = 1;
-        for (auto runInfo : runs)
+    const auto pit = pit_.Save();
+    return PitGame::Snapshot{pit, pit.level, cursorTileX_, cursorTileY_, internalTileScroll_, scrollRate_, score_, pit.tick};
+}
+
+void Playing::UpdateScore(const Pit::RunInfo& runInfo, size_t n, size_t multiplier)
+{
+    LOG(n + 1 << " size: " << runInfo.runSize << ", chain: " << runInfo.chainLength);
+    const uint64_t runScore = Scoring::RunScore(runInfo.runSize);
+    const uint64_t scoreChange = Scoring::ScoreRun(runInfo, multiplier);
+    LOG("Run score: " << runScore << " * chain length " << (runInfo.chainLength + 1) << " * multiplier " << multiplier << " = " << scoreChange);
+    score_ += scoreChange;
+    highScore_ = std::max(score_, highScore_);
+    LOG("Score: " << score_ << " High: " << highScore_);
+}
+
+void Playing::HandlePitEvents()
+{
+    // React to everything that happened in the pit since the last update.
+    const auto runs = pit_.Runs();
+    bool swapped = false;
+    bool landed = false;
+    bool popped = false;
+    pitEvents_.Drain([&](const Pit::Event& event) {
+        switch (event.type)
         {
-            LOG(n << " size: " << runInfo.runSize << ", chain: " << runInfo.chainLength);
-            ++n;
-            int runScore = 0;
-            switch (runInfo.runSize)
-            {
-            case 3:
-                runScore = 10;
-                break;
-            case 4:
-                runScore = 25;
-                break;
-            case 5:
-                runScore = 50;
-                break;
-            case 6:
-                runScore = 100;
-                break;
-            case 7:
-                runScore = 250;
-                break;
-            case 8:
-                runScore = 500;
-                break;
-            case 9:
-                runScore = 1000;
-                break;
-            default:
-                break;
-            }
-            uint64_t scoreChange = runScore * (runInfo.chainLength + 1) * multiplier;
-            LOG("Run score: " << runScore << " * chain length " << (runInfo.chainLength + 1) << " * multiplier " << multiplier << " = " << scoreChange);
-            score_ += scoreChange;
+        case Pit::Event::Type::Swap:
+            swapped = true;
+            break;
+        case Pit::Event::Type::Land:
+            landed = true;
+            break;
+        case Pit::Event::Type::SlabBroken:
+            popped = true;
+            break;
+        case Pit::Event::Type::RunCleared:
+        {
+            popped = true;
+            const auto run = runs[event.run];
+            UpdateScore(run, event.run, runs.size());
+            flyupRenderer_.AddFlyupsForRun(run, topLeft_, tileSize_, TileScroll());
+            flyupRenderer_.AddFlyupsForChains(run, topLeft_, tileSize_, TileScroll());
+            break;
         }
-        highScore_ = std::max(score_, highScore_);
-        LOG("Score: " << score_ << " High: " << highScore_);
+        default:
+            break;
+        }
+    });
+
+    if (swapped)
+    {
+        blocksSwappingSource_.Play(sounds_.blocksSwapping);
+    }
+    if (landed)
+    {
+        blocksLandingSource_.Play(sounds_.blocksLanding);
+    }
+    if (popped)
+    {
+        blocksPoppingSource_.Play(sounds_.blocksPopping);
+    }
+}
+
+bool Playing::Rewind()
+{
+    if (!buttons_.IsPressed(ButtonId::b))
+    {
+        return false;
+    }
+
+    // The oldest moment is kept, so that there's always somewhere to stop.
+    if (history_.Size() > 1)
+    {
+        history_.Pop();
+        Restore(history_.Newest());
     }
+    return true;
+}
+
+void Playing::Restore(const Moment& moment)
+{
+    const PitGame::Snapshot& position = moment.position;
+    pit_.Restore(position.pit);
+    pitEvents_.Drain([](const Pit::Event&) {});
+    cursorTileX_ = position.cursorX;
+    cursorTileY_ = position.cursorY;
+    internalTileScroll_ = position.scroll;
+    scrollRate_ = position.scrollRate;
+    score_ = position.score;
+    elapsedTicks_ = moment.elapsedTicks;
+    flyupRenderer_.Reset();
 }
 
-void Playing::UpdatePlaying(double t)
+void Playing::UpdatePlaying()
 {
-    // Scroll the contents of the pit up.
-    internalTileScroll_ += (buttons_.IsPressed(ButtonId::x) && buttons_.LastPressed(ButtonId::x) > stateStartTime_)
-            ? 1.0f
-            : scrollRate_;
-    if (internalTileScroll_ >= tileSize_)
+    // In practice mode the pit doesn't move while it's being rewound, and a pit that has filled up waits to be rewound
+    // rather than ending the game.
+    if (mode_ == Mode::PRACTICE && (Rewind() || pit_.IsImpacted()))
+    {
+        if (buttons_.JustPressed(ButtonId::back))
+        {
+            musicSource_.Pause();
+            SetState(State::PAUSED);
+        }
+        return;
+    }
+
+    // Scroll the contents of the pit up, quickly if the player has pressed and is holding the button for it. Puzzles
+    // don't scroll at all.
+    fastScrollAllowed_ = fastScrollAllowed_ || buttons_.JustPressed(ButtonId::x);
+    if (mode_ != Mode::PUZZLE)
+    {
+        internalTileScroll_ += (buttons_.IsPressed(ButtonId::x) && fastScrollAllowed_)
+                ? Difficulty::subPixelsPerPixel
+                : scrollRate_;
+    }
+    if (internalTileScroll_ >= tileSubPixels_)
     {
         pit_.ScrollOne();
         if (cursorTileY_ > 1)
         {
             cursorTileY_--;
         }
-        internalTileScroll_ = 0.0f;
+        internalTileScroll_ = 0;
     }
 
     // Move the player.
@@ -217,54 +331,89 @@ void Playing::UpdatePlaying(double t)
         ++cursorTileY_;
     }
 
-    // Swap tiles.
+    // Swap tiles. A puzzle is played the way that it was solved, one swap at a time, so a swap has to wait until the
+    // pit has settled, and only counts if it changes something.
     if (buttons_.JustPressed(ButtonId::a))
     {
-        pit_.Swap(cursorTileX_, cursorTileY_);
-        blocksSwappingSource_.Play(sounds_.blocksSwapping);
+        if (mode_ != Mode::PUZZLE)
+        {
+            pit_.Swap(cursorTileX_, cursorTileY_);
+        }
+        else if (swapsLeft_ > 0 && pit_.IsSettled())
+        {
+            const Pit::TileType left = pit_.TileTypeAt(cursorTileX_, cursorTileY_);
+            const Pit::TileType right = pit_.TileTypeAt(cursorTileX_ + 1, cursorTileY_);
+            if (left != right && left != Pit::TileType::Wall && right != Pit::TileType::Wall)
+            {
+                pit_.Swap(cursorTileX_, cursorTileY_);
+                --swapsLeft_;
+            }
+        }
     }
 
     pit_.Update();
-
-    if (pit_.Landed())
-    {
-        blocksLandingSource_.Play(sounds_.blocksLanding);
-    }
-    if (auto runs = pit_.Runs(); runs.size() > 0)
+    HandlePitEvents();
+    if (mode_ == Mode::PRACTICE)
     {
-        blocksPoppingSource_.Play(sounds_.blocksPopping);
-    }
-
-    UpdateScore();
-
-    // Add fly-ups.
-    for (const auto& run : pit_.Runs())
-    {
-        flyupRenderer_.AddFlyupsForRun(run, topLeft_, tileSize_, internalTileScroll_);
-        flyupRenderer_.AddFlyupsForChains(run, topLeft_, tileSize_, internalTileScroll_);
+        history_.Push({Position(), elapsedTicks_});
     }
 
     // Check for paused.
     if (buttons_.JustPressed(ButtonId::back))
     {
         musicSource_.Pause();
-        SetState(State::PAUSED, t);
+        SetState(State::PAUSED);
     }
 
     // Check for game over.
-    if (pit_.IsImpacted())
+    if (pit_.IsImpacted() && mode_ != Mode::PRACTICE)
+    {
+        musicSource_.Play(sounds_.musicLAdieu);
+        SetState(State::GAME_OVER);
+        actionsEnabled_ = false;
+    }
+    else if (mode_ == Mode::PUZZLE && state_ == State::PLAYING)
+    {
+        UpdatePuzzle();
+    }
+}
+
+void Playing::UpdatePuzzle()
+{
+    // A puzzle is over when the pit settles after the last swap, or as soon as it's been cleared.
+    if (!pit_.IsSettled())
+    {
+        return;
+    }
+    if (Puzzle::IsCleared(pit_))
+    {
+        puzzleSolved_ = true;
+        musicSource_.Play(sounds_.musicHallelujah);
+        SetState(State::GAME_OVER);
+        actionsEnabled_ = false;
+    }
+    else if (swapsLeft_ == 0)
     {
         musicSource_.Play(sounds_.musicLAdieu);
-        SetState(State::GAME_OVER, t);
+        SetState(State::GAME_OVER);
         actionsEnabled_ = false;
     }
 }
 
-Screens Playing::UpdateGameOver(double t)
+bool Playing::HasWon() const
+{
+    if (mode_ == Mode::PUZZLE)
+    {
+        return puzzleSolved_ && level_ < puzzles_.size();
+    }
+    return !pit_.IsImpacted();
+}
+
+Screens Playing::UpdateGameOver()
 {
     // Don't allow the player to do anything for a short time to prevent them from taking accidental actions.
-    const double delay = 2.0;
-    actionsEnabled_ = t - stateStartTime_ >= delay;
+    const uint64_t delay = 2 * UPDATES_PER_SECOND;
+    actionsEnabled_ = ticks_ - stateStartTick_ >= delay;
     if (actionsEnabled_)
     {
         if (buttons_.JustPressed(ButtonId::b))
@@ -279,25 +428,29 @@ Screens Playing::UpdateGameOver(double t)
             progress_.SaveScores();// TODO: dedup.
             if (mode_ == Mode::TIMED)
             {
-                Start(t, lastPlayed_, mode_);
+                Start(lastPlayed_, mode_);
             }
             else if (mode_ == Mode::ENDLESS)
             {
-                Start(t, initialLevel_, mode_);
+                Start(initialLevel_, mode_);
+            }
+            else if (mode_ == Mode::PUZZLE)
+            {
+                Start(level_, mode_);
             }
         }
-        if (buttons_.JustPressed(ButtonId::a) && !pit_.IsImpacted())
+        if (buttons_.JustPressed(ButtonId::a) && HasWon())
         {
-            // Go on to the next level.
+            // Go on to the next level, or the next puzzle.
             musicSource_.Stop();
             progress_.SaveScores();// TODO: dedup.
-            Start(t, level_, mode_);
+            Start(mode_ == Mode::PUZZLE ? level_ + 1 : level_, mode_);
         }
     }
     return Screens::Playing;
 }
 
-Screens Playing::UpdatePaused(double t)
+Screens Playing::UpdatePaused()
 {
     if (buttons_.JustPressed(ButtonId::b))
     {
@@ -307,32 +460,37 @@ Screens Playing::UpdatePaused(double t)
     if (buttons_.JustPressed(ButtonId::a))
     {
         musicSource_.Resume();
-        SetState(State::PLAYING, t);
+        SetState(State::PLAYING);
     }
     return Screens::Playing;
 }
 
-Screens Playing::Update(double t, double /*dt*/)
+// Replay::Run() plays recordings back by following this without the game, so any change to how the game plays must be
+// made there too.
+Screens Playing::Update(double /*t*/, double /*dt*/)
 {
-    // Update elapsed time only when playing.
-    double multiplier = (state_ == State::PLAYING) ? 1.0 : 0.0;
-    double now = t;
-    double delta = (now - lastTime_) * multiplier;
-    lastTime_ = now;
-    elapsedTime_ += delta;
+    recording_.Append(static_cast<uint16_t>(buttons_.Held()));
+    ++ticks_;
+
+    // Update elapsed time only when playing. A pit that has filled up only stays in play in practice mode.
+    const uint64_t delta = (state_ == State::PLAYING && !pit_.IsImpacted()) ? 1 : 0;
+    elapsedTicks_ += delta;
     if (mode_ == Mode::TIMED)
     {
-        remainingTime_ -= delta;
-        if (remainingTime_ < 0.0)
+        if (delta > remainingTicks_)
         {
             if (state_ == State::PLAYING)
             {
                 musicSource_.Play(sounds_.musicHallelujah);
-                SetState(State::GAME_OVER, t);
+                SetState(State::GAME_OVER);
                 SetLevel(level_ + 1);
                 actionsEnabled_ = false;
             }
-            remainingTime_ = 0.0;
+            remainingTicks_ = 0;
+        }
+        else
+        {
+            remainingTicks_ -= delta;
         }
     }
     else if (mode_ == Mode::ENDLESS)
@@ -341,23 +499,30 @@ Screens Playing::Update(double t, double /*dt*/)
         {
             musicSource_.Play(sounds_.musicGymnopedie);
         }
-        bestTime_ = std::max(bestTime_, elapsedTime_);
-        timeToNextLevelChange_ -= delta;
-        if (timeToNextLevelChange_ < 0.0)
+        bestTime_ = std::max(bestTime_, Seconds(elapsedTicks_));
+        if (delta > ticksToNextLevelChange_)
         {
             level_ = std::min(level_ + 1, numLevels_);
             SetDifficulty(level_);
-            timeToNextLevelChange_ = ENDLESS_MODE_TIME;
+            ticksToNextLevelChange_ = ENDLESS_MODE_UPDATES;
         }
+        else
+        {
+            ticksToNextLevelChange_ -= delta;
+        }
+    }
+    else if (mode_ == Mode::PRACTICE && musicSource_.IsStopped())
+    {
+        musicSource_.Play(sounds_.musicGymnopedie);
     }
 
     if (state_ == State::PLAYING)
     {
-        UpdatePlaying(t);
+        UpdatePlaying();
     }
     else if (state_ == State::GAME_OVER)
     {
-        Screens screen = UpdateGameOver(t);
+        Screens screen = UpdateGameOver();
         if (screen != Screens::Playing)
         {
             return screen;
@@ -365,7 +530,7 @@ Screens Playing::Update(double t, double /*dt*/)
     }
     else if (state_ == State::PAUSED)
     {
-        Screens screen = UpdatePaused(t);
+        Screens screen = UpdatePaused();
         if (screen != Screens::Playing)
         {
             return screen;
@@ -387,7 +552,7 @@ void Playing::DrawBackdrop()
             size_t index = lastPlayed_ - 1;
             batch_.AddVertices(je::quads::Create(textures_.backdrops[index % textures_.backdrops.size()], 0.0f, 0.0f));
         }
-        else if (mode_ == Mode::ENDLESS)
+        else if (mode_ == Mode::ENDLESS || mode_ == Mode::PUZZLE || mode_ == Mode::PRACTICE)
         {
             size_t index = level_ - 1;
             batch_.AddVertices(je::quads::Create(textures_.backdrops[index % textures_.backdrops.size()], 0.0f, 0.0f));
@@ -434,16 +599,20 @@ void Playing::DrawPaused()
     }
 }
 
-void Playing::DrawGameOver(double t)
+void Playing::DrawGameOver()
 {
     // Draw a translucent texture over the pit area again.
     batch_.AddVertices(je::quads::Create(textures_.blankSquare, topLeft_.x, topLeft_.y, tileSize_ * pit_.cols, tileSize_ * (pit_.rows - 1)));
 
     // It's game over, so tell the player.
-    if (std::fmod(t - stateStartTime_, 1.0) < 0.6)
+    if ((ticks_ - stateStartTick_) % UPDATES_PER_SECOND < UPDATES_PER_SECOND * 6 / 10)
     {
         const float y = VIRTUAL_HEIGHT / 2.0f - 4.0f - 64.0f;
-        if (pit_.IsImpacted())
+        if (mode_ == Mode::PUZZLE)
+        {
+            textRenderer_.DrawCentred(VIRTUAL_WIDTH / 2.0f, y, puzzleSolved_ ? "SOLVED!" : "TRY AGAIN", Colours::white, Colours::black);
+        }
+        else if (pit_.IsImpacted())
         {
             const float x = VIRTUAL_WIDTH / 2.0f - 5.0 * 8.0f;
             textRenderer_.DrawLeft(x, y, "GAME OVER!", Colours::white, Colours::black);
@@ -481,7 +650,7 @@ void Playing::DrawGameOver(double t)
             const float x = VIRTUAL_WIDTH / 2.0f - 6.125f * 8.0f;
             textRenderer_.DrawLeft(x, y, "[ESC]   back", Colours::white, Colours::black);
         }
-        if (!pit_.IsImpacted())
+        if (HasWon())
         {
             if (je::Human::Instance()->HasGamepad())
             {
@@ -499,6 +668,25 @@ void Playing::DrawGameOver(double t)
     }
 }
 
+void Playing::DrawRewind()
+{
+    // The pit has filled up, so tell the player how to go back.
+    if ((ticks_ - stateStartTick_) % UPDATES_PER_SECOND < UPDATES_PER_SECOND * 6 / 10)
+    {
+        const float y = VIRTUAL_HEIGHT / 2.0f - 4.0f - 64.0f;
+        textRenderer_.DrawCentred(VIRTUAL_WIDTH / 2.0f, y, "TOPPED OUT", Colours::white, Colours::black);
+    }
+    const float y = VIRTUAL_HEIGHT / 2.0f - 4.0f - 64.0f + 8.0f * 4.0f;
+    if (je::Human::Instance()->HasGamepad())
+    {
+        textRenderer_.DrawCentred(VIRTUAL_WIDTH / 2.0f, y, "hold (|) to rewind", Colours::white, Colours::black);
+    }
+    else
+    {
+        textRenderer_.DrawCentred(VIRTUAL_WIDTH / 2.0f, y, "hold [ESC] to rewind", Colours::white, Colours::black);
+    }
+}
+
 void Playing::DrawTitle()
 {
     const float x = VIRTUAL_WIDTH / 2;
@@ -512,6 +700,14 @@ void Playing::DrawTitle()
     {
         textRenderer_.DrawCentred(x, y, "Endless fun", Colours::mode, Colours::black);
     }
+    else if (mode_ == Mode::PUZZLE)
+    {
+        textRenderer_.DrawCentred(x, y, "Puzzle " + std::to_string(level_), Colours::mode, Colours::black);
+    }
+    else if (mode_ == Mode::PRACTICE)
+    {
+        textRenderer_.DrawCentred(x, y, "Practice", Colours::mode, Colours::black);
+    }
 }
 
 void Playing::DrawStats()
@@ -521,11 +717,11 @@ void Playing::DrawStats()
     batch_.AddVertices(je::quads::Create(textures_.blankSquare, topLeft_.x + tileSize_ * (pit_.cols + 1) - tileSize_ * 0.5f, topLeft_.y + tileSize_ * 2 - tileSize_ * 0.5f, tileSize_ * 5, tileSize_ * 6));
     if (mode_ == Mode::TIMED)
     {
-        timeRenderer_.Draw({topLeft_.x - tileSize_ * 3, topLeft_.y + tileSize_ * 2}, remainingTime_);
+        timeRenderer_.Draw({topLeft_.x - tileSize_ * 3, topLeft_.y + tileSize_ * 2}, Seconds(remainingTicks_));
     }
-    else if (mode_ == Mode::ENDLESS)
+    else if (mode_ == Mode::ENDLESS || mode_ == Mode::PUZZLE || mode_ == Mode::PRACTICE)
     {
-        timeRenderer_.Draw({topLeft_.x - tileSize_ * 3, topLeft_.y + tileSize_ * 2}, elapsedTime_);
+        timeRenderer_.Draw({topLeft_.x - tileSize_ * 3, topLeft_.y + tileSize_ * 2}, Seconds(elapsedTicks_));
     }
     if (mode_ == Mode::TIMED)
     {
@@ -533,10 +729,19 @@ void Playing::DrawStats()
         highScoreRenderer_.Draw({topLeft_.x + tileSize_ * (pit_.cols + 2.5f), topLeft_.y + tileSize_ * 4}, highScore_);
         speedRenderer_.Draw({topLeft_.x + tileSize_ * (pit_.cols + 2.5f), topLeft_.y + tileSize_ * 6}, lastPlayed_);
     }
+    else if (mode_ == Mode::PRACTICE)
+    {
+        scoreRenderer_.Draw({topLeft_.x + tileSize_ * (pit_.cols + 2.5f), topLeft_.y + tileSize_ * 2}, score_);
+        speedRenderer_.Draw({topLeft_.x + tileSize_ * (pit_.cols + 2.5f), topLeft_.y + tileSize_ * 4}, lastPlayed_);
+    }
     else if (mode_ == Mode::ENDLESS)
     {
         bestTimeRenderer_.Draw({topLeft_.x + tileSize_ * (pit_.cols + 2.5f), topLeft_.y + tileSize_ * 2}, bestTime_);
     }
+    else if (mode_ == Mode::PUZZLE)
+    {
+        swapsRenderer_.Draw({topLeft_.x + tileSize_ * (pit_.cols + 2.5f), topLeft_.y + tileSize_ * 2}, swapsLeft_);
+    }
 }
 
 void Playing::DrawGui()
@@ -549,19 +754,19 @@ void Playing::DrawPit()
 {
     // Draw a translucent texture over the pit area, then draw the pit itself.
     batch_.AddVertices(je::quads::Create(textures_.blankSquare, topLeft_.x, topLeft_.y, tileSize_ * pit_.cols, tileSize_ * (pit_.rows - 1)));
-    pitRenderer_.Draw(topLeft_, internalTileScroll_, bottomRow_);
+    pitRenderer_.Draw(topLeft_, TileScroll(), bottomRow_);
 }
 
 void Playing::DrawCursor()
 {
     // We're still playing, so draw the cursor.
     float cursorX = topLeft_.x + cursorTileX_ * tileSize_ - 1.0f;
-    float cursorY = topLeft_.y + cursorTileY_ * tileSize_ - 1.0f - internalTileScroll_;
+    float cursorY = topLeft_.y + cursorTileY_ * tileSize_ - 1.0f - TileScroll();
     batch_.AddVertices(je::quads::Create(textures_.cursorTile, cursorX, cursorY));
     batch_.AddVertices(je::quads::Create(textures_.cursorTile, cursorX + tileSize_, cursorY));
 }
 
-void Playing::Draw(double t)
+void Playing::Draw(double /*t*/)
 {
     DrawBackdrop();
     DrawGui();
@@ -570,10 +775,14 @@ void Playing::Draw(double t)
     if (state_ == State::PLAYING)
     {
         DrawCursor();
+        if (mode_ == Mode::PRACTICE && pit_.IsImpacted())
+        {
+            DrawRewind();
+        }
     }
     else if (state_ == State::GAME_OVER)
     {
-        DrawGameOver(t);
+        DrawGameOver();
     }
     else if (state_ == State::PAUSED)
     {
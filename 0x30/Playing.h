@@ -4,7 +4,6 @@
 #include "Constants.h"
 #include "FlyupRenderer.h"
 #include "LevelRenderer.h"
-#include "Pit.h"
 #include "PitRenderer.h"
 #include "Progress.h"
 #include "ScoreRenderer.h"
@@ -16,22 +15,44 @@
 #include "je/Batch.h"
 #include "je/MyTime.h"
 #include "je/QuadHelpers.h"
+#include "pit_core/Difficulty.h"
+#include "pit_core/History.h"
+#include "pit_core/Pit.h"
+#include "pit_core/PitGame.h"
+#include "pit_core/Puzzle.h"
+#include "pit_core/Recording.h"
+#include "pit_core/Rng.h"
 
 #include <array>
-#include <functional>
+#include <cstdint>
 #include <iomanip>
 #include <sstream>
+#include <string>
+#include <vector>
 
 class Playing
 {
 public:
-    Playing(Buttons& buttonState, Progress& progress, je::Batch& batch, Textures& textures, Sounds& sounds, std::function<int(int, int)>& rnd);
+    Playing(Buttons& buttonState, Progress& progress, je::Batch& batch, Textures& textures, Sounds& sounds, uint64_t seed,
+            const std::vector<Puzzle>& puzzles);
 
     void SetDifficulty(size_t actualLevel);
 
-    void Start(double t, size_t level, Mode mode);
+    // In puzzle mode the level is the puzzle, counting from 1.
+    void Start(size_t level, Mode mode);
+
+    // Starts a game with the given seed for its pit, e.g., to play back a recording.
+    void Start(size_t level, Mode mode, uint64_t seed);
 
     Screens Update(double t, double dt);
+
+    bool IsPlaying() const
+    {
+        return state_ == State::PLAYING;
+    }
+
+    // The position in the game, for a computer player to think about.
+    PitGame::Snapshot Position() const;
     void DrawCursor();
     void Draw(double t);
 
@@ -43,24 +64,49 @@ private:
         GAME_OVER
     };
 
-    Screens UpdateGameOver(double t);
-    Screens UpdatePaused(double t);
-    void UpdatePlaying(double t);
+    // Everything that rewinding puts back, in practice mode.
+    struct Moment
+    {
+        PitGame::Snapshot position;
+        uint64_t elapsedTicks;
+    };
+
+    Screens UpdateGameOver();
+    Screens UpdatePaused();
+    void UpdatePlaying();
+    void UpdatePuzzle();
+
+    // In practice mode, goes back an update for as long as the rewind button is held. Returns true if it's held.
+    bool Rewind();
+    void Restore(const Moment& moment);
+
+    // Whether the game that has just finished was won, so that there's a next level or puzzle to go on to.
+    bool HasWon() const;
 
     void DrawPaused();
-    void DrawGameOver(double t);
+    void DrawGameOver();
+    void DrawRewind();
     void DrawStats();
     void DrawTitle();
     void DrawPit();
     void DrawGui();
 
-    void UpdateScore();
+    void HandlePitEvents();
+    void UpdateScore(const Pit::RunInfo& runInfo, size_t n, size_t multiplier);
+    void SaveRecording();
     void DrawBackdrop();
 
     void SetLevel(size_t level);
-    void SetState(State state, double t);
+    void SetState(State state);
+
+    // The scroll in pixels, for drawing.
+    float TileScroll() const
+    {
+        return static_cast<float>(internalTileScroll_) / Difficulty::subPixelsPerPixel;
+    }
 
     const float tileSize_ = 16.0f;
+    const uint32_t tileSubPixels_ = static_cast<uint32_t>(tileSize_) * Difficulty::subPixelsPerPixel;
 
     Buttons& buttons_;
     Progress& progress_;
@@ -71,6 +117,8 @@ private:
     je::SoundSource blocksLandingSource_;
     je::SoundSource blocksPoppingSource_;
     je::SoundSource musicSource_;
+    Rng seeds_; // Seeds each new game's pit.
+    Pit::EventQueue pitEvents_; // What has happened in the pit since the last update.
     Pit pit_;
     PitRenderer pitRenderer_;
     TextRenderer textRenderer_;
@@ -78,15 +126,20 @@ private:
     TimeRenderer bestTimeRenderer_;
     ScoreRenderer scoreRenderer_;
     ScoreRenderer highScoreRenderer_;
+    ScoreRenderer swapsRenderer_;
     LevelRenderer speedRenderer_;
     FlyupRenderer flyupRenderer_;
+    Recording recording_;        // The game so far, saved when it's over so that it can be played back.
+    std::string savedRecording_; // The saved recording, which must outlive the save.
     Mode mode_;
+    const std::vector<Puzzle>& puzzles_;
 
-    double lastTime_{0.0};
-    double elapsedTime_{0.0};
-    double stateStartTime_{0.0};
-    double remainingTime_{0.0};
-    double timeToNextLevelChange_{0.0};
+    // Times are counted in updates.
+    uint64_t ticks_{0};
+    uint64_t elapsedTicks_{0};
+    uint64_t stateStartTick_{0};
+    uint64_t remainingTicks_{0};
+    uint64_t ticksToNextLevelChange_{0};
 
     State state_;
     bool actionsEnabled_{false};
@@ -94,8 +147,9 @@ private:
     const je::Vec2f topLeft_{(VIRTUAL_WIDTH - Pit::cols * tileSize_) / 2.0f, VIRTUAL_HEIGHT - Pit::rows* tileSize_};
     const float bottomRow_{topLeft_.y + (Pit::rows - 1) * tileSize_};
 
-    float internalTileScroll_{0.0f};
-    float scrollRate_{0.025f};
+    uint32_t internalTileScroll_{0};// In sub-pixels.
+    uint32_t scrollRate_{Difficulty::ScrollRateForLevel(1)};
+    bool fastScrollAllowed_{false};// Whether the fast scroll button has been pressed since the state changed.
 
     size_t cursorTileX_{(Pit::cols / 2) - 1};
     size_t cursorTileY_{Pit::rows / 2};
@@ -106,5 +160,8 @@ private:
     size_t level_{1};
     size_t lastPlayed_{1};
     size_t initialLevel_{1};
+    size_t swapsLeft_{0};      // In puzzle mode.
+    bool puzzleSolved_{false}; // In puzzle mode.
+    History<Moment> history_{60 * Difficulty::updatesPerSecond};// In practice mode, the last minute of play.
     static constexpr size_t numLevels_ = std::tuple_size<Scores>::value;
 };
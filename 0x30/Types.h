@@ -27,5 +27,7 @@ using Times = std::array<TimeRecord, 3>;
 enum class Mode
 {
     TIMED,
-    ENDLESS
+    ENDLESS,
+    PUZZLE,
+    PRACTICE
 };
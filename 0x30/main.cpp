@@ -1,8 +1,8 @@
 #include "Buttons.h"
 #include "Constants.h"
+#include "CpuPlayer.h"
 #include "Dedication.h"
 #include "Menu.h"
-#include "Pit.h"
 #include "PitRenderer.h"
 #include "Playing.h"
 #include "Progress.h"
@@ -20,6 +20,9 @@
 #include "je/Sound.h"
 #include "je/Textures.h"
 #include "je/Types.h"
+#include "pit_core/Pit.h"
+#include "pit_core/Puzzle.h"
+#include "pit_core/Recording.h"
 
 #if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN
@@ -29,11 +32,16 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
-#include <functional>
+#include <fstream>
 #include <iomanip>
+#include <memory>
 #include <random>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #if defined(_WIN32)
 struct Console
@@ -79,15 +87,41 @@ struct Console
 };
 #endif
 
+// Loads the puzzles that were made by pit_puzzles. The game can still be played without them, just not in puzzle mode.
+std::vector<Puzzle> LoadPuzzles()
+{
+    std::ifstream file("assets/puzzles.txt");
+    if (!file)
+    {
+        LOG("Unable to open assets/puzzles.txt");
+        return {};
+    }
+    try
+    {
+        std::vector<Puzzle> puzzles = Puzzle::LoadPack(file);
+        LOG("Loaded " << puzzles.size() << " puzzles");
+        return puzzles;
+    }
+    catch (const std::exception& e)
+    {
+        LOG("Unable to load puzzles: " << e.what());
+        return {};
+    }
+}
+
 class Game
 {
 public:
-    Game(std::function<int(int, int)>& rnd);
+    // Plays the game, or plays back the recording if there is one. If there's a computer player then it plays instead of
+    // the person at the keyboard.
+    Game(uint64_t seed, std::unique_ptr<Recording> replay, std::unique_ptr<CpuPlayer> cpu);
     bool ShouldQuit();
     void Update(double t, double dt);
     void Draw(double t);
 
 private:
+    void UpdateReplay(double t, double dt);
+
     je::Context context;
     je::SoundSystem soundSystem;
 
@@ -98,21 +132,31 @@ private:
     Sounds sounds;
 
     Buttons buttons_;
+    std::vector<Puzzle> puzzles_;
 
     Playing playing;
     Dedication dedication;
     Menu menu;
 
     Screens currentScreen{Screens::Dedication};
+
+    std::unique_ptr<Recording> replay_;
+    std::unique_ptr<RecordingPlayer> replayPlayer_;
+
+    std::unique_ptr<CpuPlayer> cpu_;
+    uint32_t cpuHeld_{0};// The buttons that the computer player held on the last update.
 };
 
-Game::Game(std::function<int(int, int)>& rnd)
+Game::Game(uint64_t seed, std::unique_ptr<Recording> replay, std::unique_ptr<CpuPlayer> cpu)
     : context{je::Context(WIDTH, HEIGHT, TITLE)},
       shader{je::Shader()},
       batch{shader.Program()},
-      playing{buttons_, progress_, batch, textures, sounds, rnd},
+      puzzles_{LoadPuzzles()},
+      playing{buttons_, progress_, batch, textures, sounds, seed, puzzles_},
       dedication{buttons_, batch, textures, sounds},
-      menu{buttons_, progress_, batch, textures}
+      menu{buttons_, progress_, batch, textures, puzzles_},
+      replay_{std::move(replay)},
+      cpu_{std::move(cpu)}
 {
     LOG("Shader program " << shader.Program());
     LOG("Finished initialising input");
@@ -143,6 +187,23 @@ bool Game::ShouldQuit()
 void Game::Update(double t, double dt)
 {
     je::Human::Instance()->Update(t);
+    if (replay_)
+    {
+        UpdateReplay(t, dt);
+        return;
+    }
+    if (cpu_ && currentScreen == Screens::Playing && playing.IsPlaying())
+    {
+        // The computer player's buttons go through the same path as everyone else's, so they're recorded too.
+        const uint32_t held = cpu_->Update(playing.Position());
+        buttons_.Hold((buttons_.Held() & ~cpuHeld_) | held);
+        cpuHeld_ = held;
+    }
+    else if (cpuHeld_ != 0)
+    {
+        buttons_.Hold(buttons_.Held() & ~cpuHeld_);
+        cpuHeld_ = 0;
+    }
     buttons_.Update(t);
 
     if (buttons_.JustPressed(ButtonId::debug))
@@ -174,7 +235,7 @@ void Game::Update(double t, double dt)
         currentScreen = newScreen;
         if (currentScreen == Screens::Playing)
         {
-            playing.Start(t, menu.SelectedLevel(), menu.SelectedMode());
+            playing.Start(menu.SelectedLevel(), menu.SelectedMode());
         }
         else if (currentScreen == Screens::Menu)
         {
@@ -184,6 +245,34 @@ void Game::Update(double t, double dt)
     }
 }
 
+void Game::UpdateReplay(double t, double dt)
+{
+    // Play the recording back through the same steps that recorded it, replacing whatever buttons the player is
+    // holding with the ones that were recorded.
+    if (!replayPlayer_)
+    {
+        replayPlayer_ = std::make_unique<RecordingPlayer>(*replay_);
+        buttons_.Hold(replay_->startButtons);
+        buttons_.Update(t);
+        currentScreen = Screens::Playing;
+        playing.Start(replay_->level, static_cast<Mode>(replay_->mode), replay_->seed);
+        LOG("Playing back " << replay_->Ticks() << " updates");
+        return;
+    }
+    if (replayPlayer_->AtEnd())
+    {
+        return;
+    }
+
+    buttons_.Hold(replayPlayer_->Next());
+    buttons_.Update(t);
+    playing.Update(t, dt);
+    if (replayPlayer_->AtEnd())
+    {
+        LOG("Finished playing back the recording");
+    }
+}
+
 void Game::Draw(double t)
 {
     context.Clear();
@@ -210,7 +299,11 @@ void Game::Draw(double t)
     context.SwapBuffers();
 }
 
-int main()
+// Usage: 0x30 [--replay <file> [--fast]] [--cpu easy|normal|hard]
+//
+// With --replay, plays back a game that was saved to "replay" when it ended. With --fast, plays it back as quickly as
+// the game can update rather than in real time. With --cpu, the computer plays the game at the given skill.
+int main(int argc, char* argv[])
 {
     try
     {
@@ -218,16 +311,54 @@ int main()
         Console::Hide();
 #endif
 
-        // Make a function to create random integers in a closed range.
+        std::unique_ptr<Recording> replay;
+        std::unique_ptr<CpuPlayer> cpu;
+        bool fastForward = false;
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--replay" && i + 1 < argc)
+            {
+                std::ifstream file(argv[++i], std::ios::binary);
+                if (!file)
+                {
+                    throw std::runtime_error(std::string("Unable to open ") + argv[i]);
+                }
+                replay = std::make_unique<Recording>(Recording::Load(file));
+            }
+            else if (arg == "--fast")
+            {
+                fastForward = true;
+            }
+            else if (arg == "--cpu" && i + 1 < argc)
+            {
+                const std::string skill = argv[++i];
+                if (skill == "easy")
+                {
+                    cpu = std::make_unique<CpuPlayer>(CpuPlayer::Skill::Easy);
+                }
+                else if (skill == "normal")
+                {
+                    cpu = std::make_unique<CpuPlayer>(CpuPlayer::Skill::Normal);
+                }
+                else if (skill == "hard")
+                {
+                    cpu = std::make_unique<CpuPlayer>(CpuPlayer::Skill::Hard);
+                }
+                else
+                {
+                    throw std::runtime_error("Unknown skill " + skill);
+                }
+            }
+        }
+
+        // Seed the games from the system's entropy source. Everything after this is deterministic.
         std::random_device randomDevice;
-        std::mt19937 generator(randomDevice());
-        std::function<int(int, int)> Rnd = [&](int lo, int hi) {
-            std::uniform_int_distribution<int> distribution(lo, hi);
-            return distribution(generator);
-        };
+        const uint64_t seed = (uint64_t{randomDevice()} << 32) | randomDevice();
 
-        std::unique_ptr<Game> game = std::make_unique<Game>(Rnd);
+        std::unique_ptr<Game> game = std::make_unique<Game>(seed, std::move(replay), std::move(cpu));
         je::Shell<std::unique_ptr<Game>> shell(std::move(game));
+        shell.SetFastForward(fastForward);
         shell.RunMainLoop();
         return 0;
     }
@@ -0,0 +1,151 @@
+#include "Board.h"
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    // The height of a tile that has just moved down into an empty square. Empty squares end up at this height too once
+    // a running pit has shuffled them up through each other.
+    const uint8_t fallingHeight = 15;
+
+    Pit::TileType TileTypeFor(char c)
+    {
+        switch (std::toupper(static_cast<unsigned char>(c)))
+        {
+        case '.':
+            return Pit::TileType::None;
+        case 'R':
+            return Pit::TileType::Red;
+        case 'G':
+            return Pit::TileType::Green;
+        case 'Y':
+            return Pit::TileType::Yellow;
+        case 'C':
+            return Pit::TileType::Cyan;
+        case 'M':
+            return Pit::TileType::Magenta;
+        case 'B':
+            return Pit::TileType::Blue;
+        case '#':
+            return Pit::TileType::Wall;
+        default:
+            throw std::runtime_error(std::string("Unknown tile '") + c + "'");
+        }
+    }
+} // namespace
+
+Board Board::Load(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        throw std::runtime_error("Unable to open " + path.string());
+    }
+
+    Board board;
+    board.name = path.stem().string();
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line.rfind("# ", 0) == 0)
+        {
+            continue;
+        }
+        std::istringstream words(line);
+        std::string keyword;
+        words >> keyword;
+        if (keyword == "level")
+        {
+            words >> board.level;
+        }
+        else if (keyword == "seed")
+        {
+            words >> board.seed;
+        }
+        else if (keyword == "swap")
+        {
+            words >> board.swapX >> board.swapY;
+        }
+        else if (keyword == "chain")
+        {
+            size_t x = 0;
+            size_t y = 0;
+            int chain = 0;
+            words >> x >> y >> chain;
+            board.chains.push_back(Chain{x, y, static_cast<uint8_t>(chain)});
+        }
+        else if (keyword == "slab")
+        {
+            Slab slab{};
+            words >> slab.x >> slab.y >> slab.width >> slab.height;
+            board.slabs.push_back(slab);
+        }
+        else
+        {
+            for (const char c : line)
+            {
+                TileTypeFor(c);
+            }
+            board.rows.push_back(line);
+        }
+        if (words.fail())
+        {
+            throw std::runtime_error("Bad line in " + path.string() + ": " + line);
+        }
+    }
+
+    if (board.rows.size() != Pit::rows)
+    {
+        throw std::runtime_error(path.string() + " should have " + std::to_string(Pit::rows) + " rows");
+    }
+    for (const auto& row : board.rows)
+    {
+        if (row.size() != Pit::cols)
+        {
+            throw std::runtime_error(path.string() + " should have " + std::to_string(Pit::cols) + " columns");
+        }
+    }
+    if (board.slabs.size() > Pit::maxSlabs)
+    {
+        throw std::runtime_error(path.string() + " has more than " + std::to_string(Pit::maxSlabs) + " slabs");
+    }
+    for (const auto& slab : board.slabs)
+    {
+        for (size_t y = slab.y; y < slab.y + slab.height; y++)
+        {
+            for (size_t x = slab.x; x < slab.x + slab.width; x++)
+            {
+                if (y >= Pit::rows || x >= Pit::cols || board.rows[y][x] != '#')
+                {
+                    throw std::runtime_error(path.string() + " has a slab that isn't all walls");
+                }
+            }
+        }
+    }
+    return board;
+}
+
+void Board::SetUp(Pit& pit) const
+{
+    pit.Reset(level, seed);
+    for (size_t y = 0; y < Pit::rows; y++)
+    {
+        for (size_t x = 0; x < Pit::cols; x++)
+        {
+            const char c = rows[y][x];
+            const bool falling = c == '.' || std::islower(static_cast<unsigned char>(c));
+            pit.SetTile(x, y, TileTypeFor(c), falling ? fallingHeight : 0);
+        }
+    }
+    for (const auto& chain : chains)
+    {
+        pit.SetTile(chain.x, chain.y, pit.TileTypeAt(chain.x, chain.y), static_cast<uint8_t>(pit.HeightAt(chain.x, chain.y)), chain.chain);
+    }
+    for (const auto& slab : slabs)
+    {
+        pit.SetSlab(slab.x, slab.y, slab.width, slab.height);
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "pit_core/Pit.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// A saved pit, as read from a .pit file.
+//
+// Lines starting with "# " are comments. "level n" sets the level, "seed n" sets the seed for the tiles that will
+// scroll in, "swap x y" sets where to swap, "chain x y n" gives the tile at (x, y) a chain of n, and "slab x y w h"
+// makes the walls in the w x h rectangle whose top left is at (x, y) into a slab of garbage. Every other line is a row
+// of the pit, from the top, with one character per tile:
+//  - '.' is empty and '#' is a wall. Walls that aren't part of a slab are fixed in place.
+//  - 'R', 'G', 'Y', 'C', 'M' and 'B' are fully descended red, green, yellow, cyan, magenta and blue tiles.
+//  - Lower case letters are tiles of the same colour that have just started to fall.
+//
+// Empty squares are given the same height as falling tiles, as they have in a pit that has been running for a while.
+struct Board
+{
+    struct Chain
+    {
+        size_t x;
+        size_t y;
+        uint8_t chain;
+    };
+
+    struct Slab
+    {
+        size_t x;
+        size_t y;
+        size_t width;
+        size_t height;
+    };
+
+    std::string name;
+    size_t level{1};
+    uint64_t seed{0};
+    size_t swapX{0};
+    size_t swapY{0};
+    std::vector<std::string> rows;
+    std::vector<Chain> chains;
+    std::vector<Slab> slabs;
+
+    // Throws std::runtime_error if the file can't be read or doesn't hold a board that fits in a Pit.
+    static Board Load(const std::filesystem::path& path);
+
+    // Resets the pit to this board.
+    void SetUp(Pit& pit) const;
+};
@@ -0,0 +1,118 @@
+// Measures how many game updates a second Environments can step, as a batch of bots would use it.
+//
+// Usage: pit_env_steps [--games N] [--steps N] [--threads N]
+//
+// Every game is given a random action on every step, from a table that's drawn up front so that drawing them isn't
+// timed. It's timed with every observation written, and then with only the rewards and done flags.
+
+#include "pit_core/Environments.h"
+#include "pit_core/Rng.h"
+#include "pit_core/WorkPool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        size_t games{1024};
+        size_t steps{2000};
+        size_t threads{1};
+    };
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+            const size_t value = std::strtoull(argv[++i], nullptr, 10);
+            if (arg == "--games")
+            {
+                options.games = value;
+            }
+            else if (arg == "--steps")
+            {
+                options.steps = value;
+            }
+            else if (arg == "--threads")
+            {
+                options.threads = value;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return options.games >= 1 && options.steps >= 1;
+    }
+
+    double Measure(const Options& options, const Environments::Outputs& outputs, const std::vector<uint8_t>& actions,
+                   WorkPool* pool, size_t& episodes)
+    {
+        Environments environments{options.games, Environments::Options{}};
+        environments.Reset(outputs);
+        const size_t numActions = actions.size() / options.games;
+        episodes = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t step = 0; step < options.steps; step++)
+        {
+            environments.Step(&actions[(step % numActions) * options.games], outputs, pool);
+            for (size_t i = 0; i < options.games; i++)
+            {
+                episodes += outputs.done[i];
+            }
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "Usage: %s [--games N] [--steps N] [--threads N]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Press one button, or nothing, on each step.
+    const uint8_t choices[] = {PitGame::None, PitGame::Left, PitGame::Right, PitGame::Up, PitGame::Down, PitGame::Swap};
+    const size_t numActions = 64;
+    std::vector<uint8_t> actions(numActions * options.games);
+    Rng rng{0x30};
+    for (auto& action : actions)
+    {
+        action = choices[rng.Below(sizeof(choices))];
+    }
+
+    std::vector<uint8_t> tiles(options.games * Environments::tilesPerGame);
+    std::vector<uint8_t> cursors(options.games * 2);
+    std::vector<uint32_t> scrolls(options.games);
+    std::vector<float> rewards(options.games);
+    std::vector<uint8_t> done(options.games);
+    const Environments::Outputs everything{tiles.data(), cursors.data(), scrolls.data(), rewards.data(), done.data()};
+    const Environments::Outputs rewardsOnly{nullptr, nullptr, nullptr, rewards.data(), done.data()};
+
+    std::unique_ptr<WorkPool> pool;
+    if (options.threads != 1)
+    {
+        pool = std::make_unique<WorkPool>(options.threads);
+    }
+    const double steps = static_cast<double>(options.games * options.steps);
+    for (const auto& [name, outputs] : {std::make_pair("observations", everything), std::make_pair("rewards only", rewardsOnly)})
+    {
+        size_t episodes = 0;
+        const double seconds = Measure(options, outputs, actions, pool.get(), episodes);
+        std::printf("%-12s %10.0f steps/s %7.1f ns/step %zu games ended\n", name, steps / seconds, 1e9 * seconds / steps, episodes);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+// Measures how much memory a minute of rewind history takes, and how long it takes to record and to seek, as practice
+// mode uses it.
+//
+// Usage: pit_history [--level N] [--seconds N] [--seed S]
+//
+// A game is played with random button presses for three times as long as the history holds, restarting if the pit
+// fills up, so the history has wrapped around. Every state that it still holds is then sought, in a random order, and
+// checked against a copy that was kept whole.
+
+#include "pit_core/Difficulty.h"
+#include "pit_core/History.h"
+#include "pit_core/PitGame.h"
+#include "pit_core/Rng.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        size_t level{5};
+        size_t seconds{60};
+        uint64_t seed{0x30};
+    };
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+            const uint64_t value = std::strtoull(argv[++i], nullptr, 0);
+            if (arg == "--level")
+            {
+                options.level = value;
+            }
+            else if (arg == "--seconds")
+            {
+                options.seconds = value;
+            }
+            else if (arg == "--seed")
+            {
+                options.seed = value;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return options.level >= 1 && options.level <= Difficulty::maxLevel && options.seconds >= 1;
+    }
+
+    double Microseconds(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "Usage: %s [--level N] [--seconds N] [--seed S]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const size_t capacity = options.seconds * Difficulty::updatesPerSecond;
+    History<PitGame::Snapshot> history{capacity};
+    std::vector<PitGame::Snapshot> states;
+    states.reserve(3 * capacity);
+
+    // Press a button about three times a second, as a person might.
+    Rng rng{options.seed};
+    PitGame game{options.level, rng.Next64()};
+    Clock::duration pushTime{};
+    for (size_t i = 0; i < 3 * capacity; i++)
+    {
+        const uint32_t press = rng.Below(20);
+        game.Update(press < 5 ? static_cast<uint8_t>(1u << press) : uint8_t{PitGame::None});
+        if (game.IsOver())
+        {
+            game.Reset(options.level, rng.Next64());
+        }
+        const PitGame::Snapshot state = game.Save();
+        const auto start = Clock::now();
+        history.Push(state);
+        pushTime += Clock::now() - start;
+        states.push_back(state);
+    }
+
+    std::vector<size_t> order(history.Size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+    for (size_t i = order.size() - 1; i > 0; i--)
+    {
+        std::swap(order[i], order[rng.Below(static_cast<uint32_t>(i + 1))]);
+    }
+    Clock::duration seekTime{};
+    Clock::duration worstSeek{};
+    size_t mismatches = 0;
+    for (const size_t i : order)
+    {
+        const auto start = Clock::now();
+        const PitGame::Snapshot state = history.At(i);
+        const auto elapsed = Clock::now() - start;
+        seekTime += elapsed;
+        worstSeek = std::max(worstSeek, elapsed);
+        const PitGame::Snapshot& expected = states[states.size() - history.Size() + i];
+        mismatches += (std::memcmp(&state, &expected, sizeof(state)) == 0) ? 0 : 1;
+    }
+
+    std::printf("History of %zu updates (%zu s) at level %zu\n", history.Size(), options.seconds, options.level);
+    std::printf("  %zu bytes in all, %.1f bytes per update, against %zu for a whole state\n", history.Bytes(),
+                static_cast<double>(history.Bytes()) / static_cast<double>(history.Size()), sizeof(PitGame::Snapshot));
+    std::printf("  push: %.3f us mean\n", Microseconds(pushTime) / static_cast<double>(3 * capacity));
+    std::printf("  seek: %.3f us mean, %.3f us worst\n", Microseconds(seekTime) / static_cast<double>(order.size()),
+                Microseconds(worstSeek));
+    std::printf("  %zu states didn't match\n", mismatches);
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
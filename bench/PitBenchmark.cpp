@@ -0,0 +1,208 @@
+// Times each stage of Pit::Update(), along with Pit::ScrollOne() and Pit::Swap(), against every board in the corpus.
+//
+// Each operation starts from a copy of the board as it was loaded, with every tile still to be checked for runs, apart
+// from SettledUpdate, which times Update() once the board has come to rest and been checked, as most updates in a
+// game find it.
+//
+// Each result is written to stdout as a line of JSON with the time and the number of heap allocations per operation.
+//
+//  pit_benchmark [corpus directory]
+
+#include "Board.h"
+
+#include "pit_core/Pit.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <new>
+#include <vector>
+
+#if !defined(PIT_CORPUS_DIR)
+#define PIT_CORPUS_DIR "corpus"
+#endif
+
+namespace
+{
+    std::atomic<size_t> allocations{0};
+}
+
+void* operator new(size_t size)
+{
+    ++allocations;
+    if (void* p = std::malloc(size > 0 ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+// Gives the benchmark access to the stages of Pit::Update().
+class PitBenchmark
+{
+public:
+    static void ApplyGravity(Pit& pit)
+    {
+        pit.ApplyGravity();
+    }
+
+    static void CheckForRuns(Pit& pit)
+    {
+        pit.CheckForRuns();
+    }
+
+    static void RemoveRuns(Pit& pit)
+    {
+        pit.RemoveRuns();
+    }
+};
+
+namespace
+{
+    struct Operation
+    {
+        const char* name;
+        std::function<void(Pit&)> prepare;// Untimed. Brings a copy of the board to where the operation starts.
+        std::function<void(Pit&, const Board&)> run;
+    };
+
+    struct Result
+    {
+        double nsPerOp{0};
+        double allocsPerOp{0};
+        size_t ops{0};
+    };
+
+    // Updates the pit until an update leaves nothing falling and clears no runs, so that every tile has been checked.
+    void Settle(Pit& pit)
+    {
+        const size_t maxUpdates = 10000;
+        for (size_t i = 0; i < maxUpdates; i++)
+        {
+            pit.Update();
+            if (pit.IsSettled() && pit.Runs().empty())
+            {
+                return;
+            }
+        }
+    }
+
+    Result Measure(const Board& board, const Operation& operation, uint64_t seed)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Time the operation on a batch of copies of the board at a time, so that the clock is read far less often
+        // than the operation is run, and repeat until there are enough batches to take a stable median.
+        const size_t batchSize = 256;
+        const size_t minBatches = 10;
+        const size_t maxBatches = 10000;
+        const auto minTime = std::chrono::milliseconds(100);
+
+        Pit original(seed);
+        board.SetUp(original);
+        operation.prepare(original);
+
+        std::vector<Pit> pits;
+        pits.reserve(batchSize);
+        std::vector<double> batchTimes;
+        size_t batchAllocations = 0;
+        Clock::duration totalTime{0};
+        while (batchTimes.size() < minBatches || (totalTime < minTime && batchTimes.size() < maxBatches))
+        {
+            pits.clear();
+            for (size_t i = 0; i < batchSize; i++)
+            {
+                pits.emplace_back(original);
+            }
+
+            const size_t allocationsBefore = allocations;
+            const auto start = Clock::now();
+            for (auto& pit : pits)
+            {
+                operation.run(pit, board);
+            }
+            const auto elapsed = Clock::now() - start;
+            batchAllocations += allocations - allocationsBefore;
+
+            totalTime += elapsed;
+            batchTimes.push_back(std::chrono::duration<double, std::nano>(elapsed).count() / batchSize);
+        }
+
+        std::nth_element(batchTimes.begin(), batchTimes.begin() + batchTimes.size() / 2, batchTimes.end());
+        Result result;
+        result.ops = batchTimes.size() * batchSize;
+        result.nsPerOp = batchTimes[batchTimes.size() / 2];
+        result.allocsPerOp = static_cast<double>(batchAllocations) / result.ops;
+        return result;
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const std::filesystem::path corpus = argc > 1 ? argv[1] : PIT_CORPUS_DIR;
+
+    std::vector<Board> boards;
+    try
+    {
+        std::vector<std::filesystem::path> paths;
+        for (const auto& entry : std::filesystem::directory_iterator(corpus))
+        {
+            if (entry.path().extension() == ".pit")
+            {
+                paths.push_back(entry.path());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        for (const auto& path : paths)
+        {
+            boards.push_back(Board::Load(path));
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    if (boards.empty())
+    {
+        std::fprintf(stderr, "No boards in %s\n", corpus.string().c_str());
+        return EXIT_FAILURE;
+    }
+
+    const auto nothing = [](Pit&) {};
+    const std::vector<Operation> operations = {
+            {"Update", nothing, [](Pit& pit, const Board&) { pit.Update(); }},
+            {"SettledUpdate", Settle, [](Pit& pit, const Board&) { pit.Update(); }},
+            {"ApplyGravity", nothing, [](Pit& pit, const Board&) { PitBenchmark::ApplyGravity(pit); }},
+            {"CheckForRuns", PitBenchmark::ApplyGravity, [](Pit& pit, const Board&) { PitBenchmark::CheckForRuns(pit); }},
+            {"RemoveRuns", [](Pit& pit) { PitBenchmark::ApplyGravity(pit); PitBenchmark::CheckForRuns(pit); }, [](Pit& pit, const Board&) { PitBenchmark::RemoveRuns(pit); }},
+            {"ScrollOne", nothing, [](Pit& pit, const Board&) { pit.ScrollOne(); }},
+            {"Swap", nothing, [](Pit& pit, const Board& board) { pit.Swap(board.swapX, board.swapY); }}};
+
+    for (const auto& board : boards)
+    {
+        for (const auto& operation : operations)
+        {
+            const Result result = Measure(board, operation, board.seed);
+            std::printf("{\"board\": \"%s\", \"op\": \"%s\", \"ns_per_op\": %.2f, \"allocs_per_op\": %.3f, \"ops\": %zu}\n",
+                        board.name.c_str(), operation.name, result.nsPerOp, result.allocsPerOp, result.ops);
+            std::fflush(stdout);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
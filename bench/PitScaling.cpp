@@ -0,0 +1,114 @@
+// Measures how the cost of updating a pit grows with its size, from the standard 6x13 pit up to 256x1024.
+//
+// Each size is played for a fixed number of ticks with a steady rate of random swaps and scrolls, then left to settle.
+// The results are printed as a table with the cost per tick and the cost per tile per tick.
+
+#include "pit_core/LargePit.h"
+#include "pit_core/Pit.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+namespace
+{
+    struct Result
+    {
+        double activeNsPerTick{0};
+        double settledNsPerTick{0};
+        size_t runs{0};
+    };
+
+    template<typename TPit>
+    Result Measure(TPit& pit, size_t cols, size_t rows, std::mt19937& control, size_t ticks)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Swap at the same rate per tile as a player swapping every third tick on the standard pit, and scroll once a
+        // second.
+        const size_t swapsPer1000Ticks = 1000 * cols * rows / (3 * Pit::cols * Pit::rows);
+        const size_t scrollEvery = 60;
+
+        const size_t level = 20;
+        pit.Reset(level, control());
+        Result result;
+
+        size_t swapCredit = 0;
+        const auto activeStart = Clock::now();
+        for (size_t t = 0; t < ticks; t++)
+        {
+            for (swapCredit += swapsPer1000Ticks; swapCredit >= 1000; swapCredit -= 1000)
+            {
+                pit.Swap(control() % (cols - 1), 1 + control() % (rows - 2));
+            }
+            if (t % scrollEvery == 0)
+            {
+                pit.ScrollOne();
+            }
+            pit.Update();
+            result.runs += pit.Runs().size();
+            if (pit.IsImpacted())
+            {
+                pit.Reset(level, control());
+            }
+        }
+        const auto activeEnd = Clock::now();
+
+        // Let the pit come to rest, then time it doing nothing.
+        for (size_t t = 0; t < rows * 16; t++)
+        {
+            pit.Update();
+        }
+        const auto settledStart = Clock::now();
+        for (size_t t = 0; t < ticks; t++)
+        {
+            pit.Update();
+        }
+        const auto settledEnd = Clock::now();
+
+        result.activeNsPerTick = std::chrono::duration<double, std::nano>(activeEnd - activeStart).count() / ticks;
+        result.settledNsPerTick = std::chrono::duration<double, std::nano>(settledEnd - settledStart).count() / ticks;
+        return result;
+    }
+
+    void Report(const char* name, size_t cols, size_t rows, const Result& result)
+    {
+        const double tiles = static_cast<double>(cols * rows);
+        std::printf("%-8s %4zux%-5zu %10.0f %10.3f %10.0f %10.3f %10zu\n",
+                    name, cols, rows,
+                    result.activeNsPerTick, result.activeNsPerTick / tiles,
+                    result.settledNsPerTick, result.settledNsPerTick / tiles,
+                    result.runs);
+    }
+} // namespace
+
+int main()
+{
+    std::mt19937 control(1);
+
+    const size_t ticks = 5000;
+
+    std::printf("%-8s %10s %10s %10s %10s %10s %10s\n",
+                "pit", "size", "ns/tick", "ns/tile", "rest ns", "rest/tile", "runs");
+
+    Pit pit;
+    Report("Pit", Pit::cols, Pit::rows, Measure(pit, Pit::cols, Pit::rows, control, ticks));
+
+    const size_t sizes[][2] = {
+            {6, 13},
+            {12, 26},
+            {24, 52},
+            {48, 104},
+            {96, 208},
+            {128, 512},
+            {256, 1024}};
+    for (const auto& size : sizes)
+    {
+        const size_t cols = size[0];
+        const size_t rows = size[1];
+        LargePit largePit(cols, rows);
+        Report("LargePit", cols, rows, Measure(largePit, cols, rows, control, ticks));
+    }
+
+    return 0;
+}
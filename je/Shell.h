@@ -22,6 +22,13 @@ namespace je
 
         void Update();
         void Draw();
+
+        // Runs as many updates as fit in a frame instead of keeping to real time, e.g., to play back a recording.
+        void SetFastForward(bool fastForward)
+        {
+            fastForward_ = fastForward;
+        }
+
         void Refresh();
         void RunMainLoop();
         static void EmRefresh(void* arg);
@@ -32,6 +39,7 @@ namespace je
         double lastTime = je::GetTime();
         double accumulator = 0.0;
         double lastDrawTime = je::GetTime();
+        bool fastForward_{false};
 
         TGame theGame;
     };
@@ -39,6 +47,20 @@ namespace je
     template<typename TGame>
     void Shell<TGame>::Update()
     {
+        if (fastForward_)
+        {
+            // Keep stepping until a frame's worth of real time has gone by.
+            const double start = je::GetTime();
+            do
+            {
+                theGame->Update(t, dt);
+                t += dt;
+            } while (je::GetTime() - start < dt);
+            lastTime = je::GetTime();
+            accumulator = 0.0;
+            return;
+        }
+
         // Update using: https://gafferongames.com/post/fix_your_timestep/
         double now = je::GetTime();
         double delta = now - lastTime;
@@ -0,0 +1,56 @@
+#include "Difficulty.h"
+
+#include <algorithm>
+
+size_t Difficulty::SpeedForLevel(size_t level)
+{
+    size_t speed = level - 1;
+    if (level >= 16)
+    {
+        --speed;
+    }
+    if (level >= 9)
+    {
+        --speed;
+    }
+    if (level >= 4)
+    {
+        --speed;
+    }
+    return speed;
+}
+
+uint32_t Difficulty::ScrollRateForLevel(size_t level)
+{
+    // 1/40th of a pixel per update, plus 1/400th for each step of speed.
+    return subPixelsPerPixel / 40 + static_cast<uint32_t>(SpeedForLevel(level)) * (subPixelsPerPixel / 400);
+}
+
+size_t Difficulty::EndlessStartingLevel(size_t level)
+{
+    if (level == 1)
+    {
+        return 3;
+    }
+    if (level == 2)
+    {
+        return 6;
+    }
+    if (level == 3)
+    {
+        return 9;
+    }
+    return 1;
+}
+
+uint32_t Difficulty::GarbageIntervalForLevel(size_t level)
+{
+    // Every 24 seconds at level 1, and a second sooner with each level after that.
+    const auto seconds = static_cast<uint32_t>(25 - std::min(level, maxLevel));
+    return seconds * updatesPerSecond;
+}
+
+size_t Difficulty::GarbageRowsForLevel(size_t level)
+{
+    return 1 + std::min(level, maxLevel) / 8;
+}
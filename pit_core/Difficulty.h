@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// The rules that make each level harder than the last.
+struct Difficulty
+{
+    // The number of tile colours that are in play at the given level.
+    static constexpr size_t ColoursForLevel(size_t level)
+    {
+        if (level <= 3)// Levels 1-3 have 3 tile types.
+        {
+            return 3;
+        }
+        if (level <= 8)// Levels 4-8 have 4 tile types.
+        {
+            return 4;
+        }
+        if (level <= 15)// Levels 9-15 have 5 tile types.
+        {
+            return 5;
+        }
+        return 6;// Levels 16-20 have 6 tile types.
+    }
+
+    // The speed at the given level. It goes up by one with each level, but doesn't increase when new colours are
+    // introduced.
+    static size_t SpeedForLevel(size_t level);
+
+    // The highest level.
+    static constexpr size_t maxLevel = 20;
+
+    // How long a timed game lasts, and how long each level of an endless game lasts, in updates.
+    static constexpr uint32_t updatesPerSecond = 60;
+    static constexpr uint32_t timedModeUpdates = 98 * updatesPerSecond;
+    static constexpr uint32_t endlessModeUpdates = 98 * updatesPerSecond;
+
+    // Scrolling is counted in whole fractions of a pixel so that it adds up to exactly the same thing on every platform.
+    static constexpr uint32_t subPixelsPerPixel = 400;
+
+    // The rate at which the pit scrolls at the given level, in sub-pixels per update.
+    static uint32_t ScrollRateForLevel(size_t level);
+
+    // The level that endless mode starts at for the given choice of starting level.
+    static size_t EndlessStartingLevel(size_t level);
+
+    // How often a slab of garbage drops into an endless game at the given level, in updates, and how many rows deep
+    // the slabs can be.
+    static uint32_t GarbageIntervalForLevel(size_t level);
+    static size_t GarbageRowsForLevel(size_t level);
+};
@@ -0,0 +1,115 @@
+#include "Environments.h"
+
+#include "WorkPool.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Enough games for a task that sharing them out costs far less than stepping them.
+    const size_t gamesPerTask = 64;
+} // namespace
+
+Environments::Environments(size_t count, const Options& options)
+    : options_{options}, games_(count), episodes_(count, 0)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        Start(i);
+    }
+}
+
+void Environments::Start(size_t i)
+{
+    // Each game gets its own seed from its environment and how many games that environment has played, so it doesn't
+    // matter which order the games are started in.
+    const uint64_t seed = Zobrist::Mix(options_.seed ^ Zobrist::Mix((uint64_t{i} << 32u) | episodes_[i]));
+    ++episodes_[i];
+    games_[i].Reset(options_.level, seed);
+}
+
+void Environments::Reset(const Outputs& outputs)
+{
+    for (size_t i = 0; i < games_.size(); i++)
+    {
+        episodes_[i] = 0;
+        Start(i);
+        Observe(i, outputs);
+        if (outputs.rewards)
+        {
+            outputs.rewards[i] = 0.0f;
+        }
+        if (outputs.done)
+        {
+            outputs.done[i] = 0;
+        }
+    }
+}
+
+void Environments::Step(const uint8_t* actions, const Outputs& outputs, WorkPool* pool)
+{
+    if (!pool || games_.size() <= gamesPerTask)
+    {
+        StepRange(0, games_.size(), actions, outputs);
+        return;
+    }
+
+    // Every game writes to its own entries, so the tasks share nothing.
+    for (size_t begin = 0; begin < games_.size(); begin += gamesPerTask)
+    {
+        const size_t end = std::min(begin + gamesPerTask, games_.size());
+        pool->Submit([this, begin, end, actions, &outputs](size_t) { StepRange(begin, end, actions, outputs); });
+    }
+    pool->Wait();
+}
+
+void Environments::StepRange(size_t begin, size_t end, const uint8_t* actions, const Outputs& outputs)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        PitGame& game = games_[i];
+        const uint64_t score = game.Score();
+        game.Update(actions[i]);
+        if (outputs.rewards)
+        {
+            outputs.rewards[i] = static_cast<float>(game.Score() - score);
+        }
+        const bool done = game.IsOver() || game.Ticks() >= options_.maxTicks;
+        if (outputs.done)
+        {
+            outputs.done[i] = done ? 1 : 0;
+        }
+        if (done)
+        {
+            Start(i);
+        }
+        Observe(i, outputs);
+    }
+}
+
+void Environments::Observe(size_t i, const Outputs& outputs) const
+{
+    const PitGame& game = games_[i];
+    if (outputs.tiles)
+    {
+        const Pit& pit = game.GetPit();
+        uint8_t* tiles = outputs.tiles + i * tilesPerGame;
+        for (size_t y = 0; y < Pit::rows; y++)
+        {
+            for (size_t x = 0; x < Pit::cols; x++)
+            {
+                *tiles++ = static_cast<uint8_t>(pit.TileTypeAt(x, y));
+            }
+        }
+    }
+    if (outputs.cursors)
+    {
+        outputs.cursors[2 * i] = static_cast<uint8_t>(game.CursorX());
+        outputs.cursors[2 * i + 1] = static_cast<uint8_t>(game.CursorY());
+    }
+    if (outputs.scrolls)
+    {
+        outputs.scrolls[i] = game.Scroll();
+    }
+}
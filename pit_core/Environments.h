@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Difficulty.h"
+#include "PitGame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class WorkPool;
+
+// Many games that are stepped together, one update each per call, for training bots to play. It follows the usual
+// shape of a batch of reinforcement learning environments: each step takes an action for every game, and writes what
+// every game looks like afterwards, the score that it gained, and whether it ended.
+//
+// Everything that a step writes goes straight into buffers that belong to the caller, laid out one array per kind of
+// thing with an entry per game, so that they can be handed to a learner as they are. A game that ends is started again
+// straight away with a new seed, so its observation is the first of its next game rather than the last of the one that
+// ended, and its reward is what it scored on its last update.
+class Environments
+{
+public:
+    struct Options
+    {
+        size_t level{1};
+        uint64_t seed{0x30};                            // Every game's seeds are drawn from this, so a batch always plays the same way.
+        uint32_t maxTicks{Difficulty::timedModeUpdates};// A game that lasts this long ends, as a timed game does.
+    };
+
+    // Where to write each step's results. Each must have room for an entry for every game, or be null to leave it out.
+    struct Outputs
+    {
+        uint8_t* tiles{nullptr};   // Pit::cols * Pit::rows per game. A Pit::TileType for each tile, from the top row.
+        uint8_t* cursors{nullptr}; // 2 per game. The cursor's x then its y.
+        uint32_t* scrolls{nullptr};// How far each pit has scrolled towards its next row, in sub-pixels.
+        float* rewards{nullptr};   // The score that each game gained on the step.
+        uint8_t* done{nullptr};    // 1 if the game ended on the step, otherwise 0.
+    };
+
+    static constexpr size_t tilesPerGame = Pit::cols * Pit::rows;
+
+    Environments(size_t count, const Options& options);
+
+    size_t Size() const
+    {
+        return games_.size();
+    }
+
+    const PitGame& Game(size_t i) const
+    {
+        return games_[i];
+    }
+
+    // Starts every game again from the beginning, and writes their first observations. Rewards and done flags are
+    // cleared.
+    void Reset(const Outputs& outputs);
+
+    // Updates every game once with its actions, which are PitGame::Action bits. If a pool is given then the games are
+    // shared out between its workers, and the results are the same as without it.
+    void Step(const uint8_t* actions, const Outputs& outputs, WorkPool* pool = nullptr);
+
+private:
+    void Start(size_t i);
+    void StepRange(size_t begin, size_t end, const uint8_t* actions, const Outputs& outputs);
+    void Observe(size_t i, const Outputs& outputs) const;
+
+    Options options_;
+    std::vector<PitGame> games_;
+    std::vector<uint64_t> episodes_;// The number of games that each environment has started.
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// A fixed-size queue of events from one producer to one consumer, which may be on different threads. Neither side ever
+// allocates or waits. If the consumer falls so far behind that the ring is full then new events are dropped, and
+// counted, rather than overwriting events that the consumer hasn't seen.
+template<typename T, size_t Capacity>
+class EventRing
+{
+public:
+    static constexpr size_t capacity = Capacity;
+
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "An EventRing's capacity must be a power of 2");
+
+    EventRing() = default;
+
+    // Copying a ring copies the events that haven't been drained. Neither ring may be in use by another thread.
+    EventRing(const EventRing& other)
+        : events_{other.events_},
+          read_{other.read_.load(std::memory_order_relaxed)},
+          write_{other.write_.load(std::memory_order_relaxed)},
+          dropped_{other.dropped_.load(std::memory_order_relaxed)}
+    {
+    }
+
+    EventRing& operator=(const EventRing& other)
+    {
+        events_ = other.events_;
+        read_.store(other.read_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        write_.store(other.write_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        dropped_.store(other.dropped_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    // Adds an event. Only the producer may call this.
+    void Push(const T& event)
+    {
+        const uint32_t write = write_.load(std::memory_order_relaxed);
+        if (write - read_.load(std::memory_order_acquire) == capacity)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        events_[write & (capacity - 1)] = event;
+        write_.store(write + 1, std::memory_order_release);
+    }
+
+    // Passes each event that has been pushed so far to f, oldest first, then removes them. Only the consumer may call
+    // this. Returns the number of events.
+    template<typename F>
+    size_t Drain(F&& f)
+    {
+        uint32_t read = read_.load(std::memory_order_relaxed);
+        const uint32_t write = write_.load(std::memory_order_acquire);
+        const size_t count = write - read;
+        for (; read != write; read++)
+        {
+            f(events_[read & (capacity - 1)]);
+        }
+        read_.store(read, std::memory_order_release);
+        return count;
+    }
+
+    size_t Size() const
+    {
+        return write_.load(std::memory_order_acquire) - read_.load(std::memory_order_acquire);
+    }
+
+    // The number of events that have been dropped because the ring was full.
+    size_t Dropped() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::array<T, capacity> events_{};
+    std::atomic<uint32_t> read_{0};
+    std::atomic<uint32_t> write_{0};
+    std::atomic<uint32_t> dropped_{0};
+};
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// The states that a game has been through, most recent last, for rewinding it. Only the most recent states are kept.
+//
+// A game changes very little from one update to the next, so most states are kept as a delta from the state before:
+// the bytes that changed, as runs of unchanged and changed bytes. Every so often a whole state is kept as a keyframe, so
+// getting any state back means starting from a keyframe and applying at most keyframeInterval - 1 deltas. The keyframes
+// and their deltas are kept in blocks that are reused once they're full, so nothing is allocated once the history has
+// filled up.
+template<typename State>
+class History
+{
+public:
+    static_assert(std::is_trivially_copyable_v<State>, "A History's states are copied and compared as bytes");
+
+    // Keeps at least capacity states.
+    explicit History(size_t capacity, size_t keyframeInterval = 60)
+        : interval_{std::max<size_t>(keyframeInterval, 1)},
+          blocks_((std::max<size_t>(capacity, 1) + interval_ - 1) / interval_ + 1)
+    {
+    }
+
+    void Clear()
+    {
+        begin_ = 0;
+        end_ = 0;
+    }
+
+    // Adds the newest state.
+    void Push(const State& state)
+    {
+        Block& block = blocks_[(end_ / interval_) % blocks_.size()];
+        if (end_ % interval_ == 0)
+        {
+            block.keyframe = state;
+            block.deltas.clear();
+            block.offsets.clear();
+        }
+        else
+        {
+            block.offsets.push_back(static_cast<uint32_t>(block.deltas.size()));
+            Encode(last_, state, block.deltas);
+        }
+        last_ = state;
+        ++end_;
+
+        // The oldest block is forgotten when its slot is reused.
+        const size_t oldest = (end_ - 1) / interval_ + 1;
+        if (oldest > blocks_.size())
+        {
+            begin_ = std::max(begin_, (oldest - blocks_.size()) * interval_);
+        }
+    }
+
+    // Forgets the newest state.
+    void Pop()
+    {
+        if (end_ == begin_)
+        {
+            return;
+        }
+        --end_;
+        const size_t count = end_ % interval_;
+        if (count > 0)
+        {
+            Block& block = blocks_[(end_ / interval_) % blocks_.size()];
+            block.deltas.resize(block.offsets[count - 1]);
+            block.offsets.resize(count - 1);
+        }
+        if (end_ > begin_)
+        {
+            last_ = At(Size() - 1);
+        }
+    }
+
+    size_t Size() const
+    {
+        return end_ - begin_;
+    }
+
+    bool IsEmpty() const
+    {
+        return end_ == begin_;
+    }
+
+    // Returns a state, counting from 0 for the oldest.
+    State At(size_t i) const
+    {
+        const size_t n = begin_ + i;
+        const Block& block = blocks_[(n / interval_) % blocks_.size()];
+        const size_t count = n % interval_;
+        uint8_t bytes[sizeof(State)];
+        std::memcpy(bytes, &block.keyframe, sizeof(State));
+        for (size_t j = 0; j < count; j++)
+        {
+            const size_t end = (j + 1 < block.offsets.size()) ? block.offsets[j + 1] : block.deltas.size();
+            Decode(block.deltas.data() + block.offsets[j], block.deltas.data() + end, bytes);
+        }
+        State state;
+        std::memcpy(&state, bytes, sizeof(State));
+        return state;
+    }
+
+    const State& Newest() const
+    {
+        return last_;
+    }
+
+    // The number of bytes that the history's states take up, including the space that's been kept for reuse.
+    size_t Bytes() const
+    {
+        size_t bytes = 0;
+        for (const Block& block : blocks_)
+        {
+            bytes += sizeof(block.keyframe) + block.deltas.capacity() + block.offsets.capacity() * sizeof(uint32_t);
+        }
+        return bytes;
+    }
+
+private:
+    struct Block
+    {
+        State keyframe;
+        std::vector<uint8_t> deltas;
+        std::vector<uint32_t> offsets;// Where each state's delta starts.
+    };
+
+    // A delta is a list of runs, each of which is the number of bytes to skip, the number that changed, then the
+    // changed bytes XORed with what they were. Both counts are a byte, as states are small.
+    static void Encode(const State& from, const State& to, std::vector<uint8_t>& out)
+    {
+        uint8_t a[sizeof(State)];
+        uint8_t b[sizeof(State)];
+        std::memcpy(a, &from, sizeof(State));
+        std::memcpy(b, &to, sizeof(State));
+        size_t i = 0;
+        while (i < sizeof(State))
+        {
+            size_t skip = 0;
+            while (i + skip < sizeof(State) && a[i + skip] == b[i + skip] && skip < 255)
+            {
+                ++skip;
+            }
+            i += skip;
+            size_t changed = 0;
+            while (i + changed < sizeof(State) && a[i + changed] != b[i + changed] && changed < 255)
+            {
+                ++changed;
+            }
+            if (changed == 0 && i < sizeof(State))
+            {
+                // A long run of unchanged bytes is split into runs with nothing changed.
+                out.push_back(static_cast<uint8_t>(skip));
+                out.push_back(0);
+                continue;
+            }
+            if (changed > 0)
+            {
+                out.push_back(static_cast<uint8_t>(skip));
+                out.push_back(static_cast<uint8_t>(changed));
+                for (size_t j = 0; j < changed; j++)
+                {
+                    out.push_back(a[i + j] ^ b[i + j]);
+                }
+                i += changed;
+            }
+        }
+    }
+
+    static void Decode(const uint8_t* delta, const uint8_t* end, uint8_t* bytes)
+    {
+        size_t i = 0;
+        while (delta < end)
+        {
+            i += delta[0];
+            const size_t changed = delta[1];
+            delta += 2;
+            for (size_t j = 0; j < changed; j++)
+            {
+                bytes[i + j] ^= delta[j];
+            }
+            i += changed;
+            delta += changed;
+        }
+    }
+
+    size_t interval_;
+    std::vector<Block> blocks_;
+    size_t begin_{0};// The number of the oldest state that's kept, counting from the first that was pushed.
+    size_t end_{0};
+    State last_;
+};
@@ -0,0 +1,387 @@
+#include "LargePit.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#define TILE_HEIGHT 15
+
+LargePit::LargePit(size_t cols, size_t rows, uint64_t seed)
+    : cols_{cols}, rows_{rows}, seed_{seed}, upcoming_{cols}
+{
+    if (cols < minCols || rows < minRows || cols > maxCols || rows > maxRows)
+    {
+        throw std::invalid_argument("LargePit must be between 3x4 and 256x1024 tiles");
+    }
+    tiles_.resize(cols_ * rows_);
+    runIds_.resize(cols_ * rows_);
+    isDirty_.resize(cols_ * rows_);
+    isChained_.resize(cols_ * rows_);
+    activeTop_.resize(cols_, rows_);
+    activeBottom_.resize(cols_, 0);
+    runs_.reserve(cols_ * rows_ / 3);
+    runCoords_.reserve(cols_ * rows_);
+    upcoming_.Reset(seed_, Difficulty::ColoursForLevel(level_));
+}
+
+void LargePit::SetLevel(size_t level)
+{
+    level_ = level;
+    upcoming_.SetColours(Difficulty::ColoursForLevel(level_));
+}
+
+void LargePit::Reset(size_t level, uint64_t seed)
+{
+    level_ = level;
+    seed_ = seed;
+    upcoming_.Reset(seed_, Difficulty::ColoursForLevel(level_));
+    std::fill(tiles_.begin(), tiles_.end(), Tile());
+    std::fill(runIds_.begin(), runIds_.end(), 0);
+    std::fill(isDirty_.begin(), isDirty_.end(), uint8_t{0});
+    std::fill(isChained_.begin(), isChained_.end(), uint8_t{0});
+    std::fill(activeTop_.begin(), activeTop_.end(), rows_);
+    std::fill(activeBottom_.begin(), activeBottom_.end(), 0);
+    dirty_.clear();
+    chained_.clear();
+    firstRow_ = 0;
+    RefillRows(rows_ / 2);
+    impacted_ = false;
+    landed_ = false;
+    runs_.clear();
+    runCoords_.clear();
+}
+
+void LargePit::MarkDirty(size_t x, size_t y)
+{
+    // Runs can only form around tiles that changed. A change may also leave a gap under a tile, or put a tile over a
+    // gap, so gravity needs to look at this row and the one below it.
+    const auto i = static_cast<Index>(PitIndex(x, y));
+    if (isDirty_[i] == 0)
+    {
+        isDirty_[i] = 1;
+        dirty_.push_back(i);
+    }
+    MarkActive(x, y, y + 1);
+}
+
+void LargePit::MarkActive(size_t x, size_t top, size_t bottom)
+{
+    activeTop_[x] = std::min(activeTop_[x], top);
+    activeBottom_[x] = std::max(activeBottom_[x], bottom);
+}
+
+void LargePit::MarkChained(Index i)
+{
+    if (isChained_[i] == 0)
+    {
+        isChained_[i] = 1;
+        chained_.push_back(i);
+    }
+}
+
+void LargePit::SetChain(size_t x, size_t y, uint8_t chain)
+{
+    TileAt(x, y).chain = chain;
+    if (chain > 0)
+    {
+        MarkChained(static_cast<Index>(PitIndex(x, y)));
+    }
+}
+
+void LargePit::ClearTile(size_t x, size_t y)
+{
+    TileAt(x, y) = Tile{};
+    runIds_[PitIndex(x, y)] = 0;
+    MarkDirty(x, y);
+}
+
+void LargePit::MoveDown(size_t x, size_t y)
+{
+    std::swap(TileAt(x, y), TileAt(x, y - 1));
+    TileAt(x, y).height = TILE_HEIGHT;
+    MarkDirty(x, y);
+    MarkDirty(x, y - 1);
+
+    // The chain moves with the tile.
+    if (TileAt(x, y).chain > 0)
+    {
+        MarkChained(static_cast<Index>(PitIndex(x, y)));
+    }
+}
+
+void LargePit::Refill(size_t row)
+{
+    const TileType* next = upcoming_.Peek();
+    for (size_t x = 0; x < cols_; x++)
+    {
+        TileAt(x, row) = Tile(next[x]);
+        runIds_[PitIndex(x, row)] = 0;
+        MarkDirty(x, row);
+    }
+    upcoming_.Pop();
+}
+
+void LargePit::RefillRows(size_t numRows)
+{
+    for (size_t row = rows_ - numRows; row != rows_; row++)
+    {
+        Refill(row);
+    }
+}
+
+void LargePit::ScrollOne()
+{
+    // The old top row wraps around to become the bottom row. Refilling it marks it as dirty, which in turn causes the
+    // row above it to be checked now that it's supported.
+    firstRow_ = (firstRow_ + 1) % rows_;
+    for (size_t x = 0; x < cols_; x++)
+    {
+        if (activeTop_[x] <= activeBottom_[x])
+        {
+            activeTop_[x] = activeTop_[x] > 0 ? activeTop_[x] - 1 : 0;
+            activeBottom_[x] = activeBottom_[x] > 0 ? activeBottom_[x] - 1 : 0;
+        }
+    }
+    Refill(rows_ - 1);
+
+    // The pit is impacted if there are any non-empty tiles in the top row.
+    for (size_t x = 0; x < cols_; x++)
+    {
+        if (IsFilled(x, 0))
+        {
+            impacted_ = true;
+            break;
+        }
+    }
+}
+
+void LargePit::Swap(size_t x, size_t y)
+{
+    auto& tile1 = TileAt(x, y);
+    auto& tile2 = TileAt(x + 1, y);
+    if (tile1.IsMovableType() && tile2.IsMovableType())
+    {
+        std::swap(tile1, tile2);
+        MarkDirty(x, y);
+        MarkDirty(x + 1, y);
+        if (tile1.chain > 0)
+        {
+            MarkChained(static_cast<Index>(PitIndex(x, y)));
+        }
+        if (tile2.chain > 0)
+        {
+            MarkChained(static_cast<Index>(PitIndex(x + 1, y)));
+        }
+    }
+}
+
+void LargePit::Update()
+{
+    ApplyGravity();
+    CheckForRuns();
+    RemoveRuns();
+    RemoveDeadChains();
+}
+
+void LargePit::ApplyGravity()
+{
+    // Only visit columns that changed since they last came to rest.
+    bool landed = false;
+    for (size_t x = 0; x < cols_; x++)
+    {
+        if (activeTop_[x] <= activeBottom_[x])
+        {
+            ApplyGravity(x, landed);
+        }
+    }
+    landed_ = landed;
+}
+
+void LargePit::ApplyGravity(size_t x, bool& landed)
+{
+    // Work up the column through the active rows, then carry on for as long as tiles are moving down into the gaps
+    // that are left behind. Everything that is still falling, or that moves, stays active for the next update.
+    const size_t top = std::max<size_t>(activeTop_[x], 1);
+    const size_t bottom = std::min(activeBottom_[x], rows_ - 2);
+    activeTop_[x] = rows_;
+    activeBottom_[x] = 0;
+    bool moved = false;
+    for (size_t y = bottom; y != 0 && (y >= top || moved); y--)
+    {
+        // If the current square is empty and the one above contains a tile that is fully descended then move it
+        // down to this square.
+        moved = !IsFilled(x, y) && IsSettled(x, y - 1);
+        if (moved)
+        {
+            MoveDown(x, y);
+        }
+
+        // If a tile is not fully descended then bring it down.
+        auto& tile = TileAt(x, y);
+        if (!tile.IsEmpty() && tile.IsMovableType() && !tile.IsDescended())
+        {
+            MarkActive(x, y, y);
+
+            // Did the tile just fully descend onto a non-empty tile?
+            if (--tile.height == 0)
+            {
+                MarkDirty(x, y);
+                if (IsFilled(x, y + 1))
+                {
+                    // If the non-empty tile is either not movable, or is descended itself, then the tile just landed.
+                    const auto& below = TileAt(x, y + 1);
+                    if (!below.IsMovableType() || below.IsDescended())
+                    {
+                        landed = true;
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool LargePit::LinksDown(size_t x, size_t y) const
+{
+    // A vertical pair is linked if the tile below the pair is non-empty.
+    return IsFilled(x, y + 2) && IsSettled(x, y) && IsSettled(x, y + 1)
+           && TileAt(x, y).tileType == TileAt(x, y + 1).tileType;
+}
+
+bool LargePit::LinksRight(size_t x, size_t y) const
+{
+    // A horizontal pair is linked if the tiles below both of them are non-empty.
+    return x + 1 < cols_ && IsFilled(x, y + 1) && IsFilled(x + 1, y + 1) && IsSettled(x, y) && IsSettled(x + 1, y)
+           && TileAt(x, y).tileType == TileAt(x + 1, y).tileType;
+}
+
+bool LargePit::IsInVerticalLine(size_t x, size_t y) const
+{
+    const bool up = y > 0 && LinksDown(x, y - 1);
+    const bool down = LinksDown(x, y);
+    return (up && down) || (up && y > 1 && LinksDown(x, y - 2)) || (down && LinksDown(x, y + 1));
+}
+
+bool LargePit::IsInHorizontalLine(size_t x, size_t y) const
+{
+    const bool left = x > 0 && LinksRight(x - 1, y);
+    const bool right = LinksRight(x, y);
+    return (left && right) || (left && x > 1 && LinksRight(x - 2, y)) || (right && LinksRight(x + 1, y));
+}
+
+void LargePit::CheckForRuns()
+{
+    // Any new run must include a tile that changed since the last check, or must be supported by one, because runs are
+    // removed as soon as they're found. So look for 3 linked tiles in a line around each of the tiles that changed.
+    runs_.clear();
+    runCoords_.clear();
+    for (const auto i : dirty_)
+    {
+        isDirty_[i] = 0;
+        const auto [x, y] = CoordOf(i);
+        if (runIds_[i] == 0 && (IsInVerticalLine(x, y) || IsInHorizontalLine(x, y)))
+        {
+            LabelRun(x, y);
+        }
+        if (y > 0 && runIds_[PitIndex(x, y - 1)] == 0 && (IsInVerticalLine(x, y - 1) || IsInHorizontalLine(x, y - 1)))
+        {
+            LabelRun(x, y - 1);
+        }
+    }
+    dirty_.clear();
+}
+
+void LargePit::LabelRun(size_t x, size_t y)
+{
+    // Add every tile that is linked to the given tile to a new run.
+    const auto run = static_cast<uint32_t>(runs_.size() + 1);
+    runs_.emplace_back();
+    auto& runRecord = runs_.back();
+    runRecord.first = static_cast<uint32_t>(runCoords_.size());
+
+    pending_.clear();
+    pending_.push_back(static_cast<Index>(PitIndex(x, y)));
+    runIds_[pending_.back()] = run;
+    auto add = [this, run](size_t nx, size_t ny) {
+        const auto i = static_cast<Index>(PitIndex(nx, ny));
+        if (runIds_[i] == 0)
+        {
+            runIds_[i] = run;
+            pending_.push_back(i);
+        }
+    };
+    while (!pending_.empty())
+    {
+        const Index i = pending_.back();
+        pending_.pop_back();
+        const PitCoord coord = CoordOf(i);
+        runCoords_.push_back(coord);
+        ++runRecord.runSize;
+        runRecord.chainLength = std::max<size_t>(runRecord.chainLength, tiles_[i].chain);
+
+        if (coord.y > 0 && LinksDown(coord.x, coord.y - 1))
+        {
+            add(coord.x, coord.y - 1);
+        }
+        if (LinksDown(coord.x, coord.y))
+        {
+            add(coord.x, coord.y + 1);
+        }
+        if (coord.x > 0 && LinksRight(coord.x - 1, coord.y))
+        {
+            add(coord.x - 1, coord.y);
+        }
+        if (LinksRight(coord.x, coord.y))
+        {
+            add(coord.x + 1, coord.y);
+        }
+    }
+}
+
+void LargePit::RemoveRuns()
+{
+    // Clear all of the runs.
+    for (const auto& coord : runCoords_)
+    {
+        ClearTile(coord.x, coord.y);
+    }
+
+    // If there's a fully descended block in the row above a cleared tile then set its chain count to one more than the
+    // maximum chain length for the tile's run.
+    for (const auto& runInfo : Runs())
+    {
+        const auto chain = static_cast<uint8_t>(std::min<size_t>(runInfo.chainLength + 1, UINT8_MAX));
+        for (size_t i = 0; i < runInfo.runSize; i++)
+        {
+            const auto& coord = runInfo.coord[i];
+            if (coord.y > 0 && IsSettled(coord.x, coord.y - 1))
+            {
+                SetChain(coord.x, coord.y - 1, chain);
+            }
+        }
+    }
+}
+
+void LargePit::RemoveDeadChains()
+{
+    // Reset the chain of any fully descended block that is blocked below by a fully descended block, and forget about
+    // any tile that no longer has a chain.
+    size_t kept = 0;
+    for (const auto i : chained_)
+    {
+        auto& tile = tiles_[i];
+        const auto [x, y] = CoordOf(i);
+        if (tile.chain > 0 && tile.IsDescended() && IsFilled(x, y + 1) && TileAt(x, y + 1).IsDescended())
+        {
+            tile.chain = 0;
+        }
+        if (tile.chain > 0)
+        {
+            chained_[kept++] = i;
+        }
+        else
+        {
+            isChained_[i] = 0;
+        }
+    }
+    chained_.resize(kept);
+}
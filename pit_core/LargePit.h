@@ -0,0 +1,164 @@
+#pragma once
+
+#include "Pit.h"
+#include "RowQueue.h"
+
+#include <cstdint>
+#include <vector>
+
+// A pit whose size is chosen at runtime, for boards that are far larger than the one in the game. It follows the same
+// rules as Pit, but everything it does per update is proportional to the number of tiles that changed, or that are
+// falling, rather than to the size of the pit.
+//
+// Unlike Pit, the bottom row doesn't wrap around to the top row, so tiles in the bottom row are never supported.
+class LargePit : public PitTypes
+{
+public:
+    static constexpr size_t minCols = 3;
+    static constexpr size_t minRows = 4;
+    static constexpr size_t maxCols = 256;
+    static constexpr size_t maxRows = 1024;
+
+    // The rows that will scroll into the bottom of the pit.
+    using UpcomingRows = RowQueue<0, 16>;
+
+    // Throws std::invalid_argument if the pit is smaller than minCols x minRows or larger than maxCols x maxRows.
+    LargePit(size_t cols, size_t rows, uint64_t seed = 0);
+
+    // Starts a new game at the given level. The seed decides which tiles refill the pit.
+    void Reset(size_t level, uint64_t seed);
+    void SetLevel(size_t level);
+    void Update();
+    void ScrollOne();
+    void Swap(size_t x, size_t y);
+
+    size_t Cols() const
+    {
+        return cols_;
+    }
+
+    size_t Rows() const
+    {
+        return rows_;
+    }
+
+    int HeightAt(size_t x, size_t y) const
+    {
+        return tiles_[PitIndex(x, y)].height;
+    }
+
+    TileType TileTypeAt(size_t x, size_t y) const
+    {
+        return tiles_[PitIndex(x, y)].tileType;
+    }
+
+    uint64_t Seed() const
+    {
+        return seed_;
+    }
+
+    const UpcomingRows& Upcoming() const
+    {
+        return upcoming_;
+    }
+
+    bool IsImpacted() const
+    {
+        return impacted_;
+    }
+
+    bool Landed() const
+    {
+        return landed_;
+    }
+
+    RunView Runs() const
+    {
+        return RunView(runs_.data(), runs_.size(), runCoords_.data());
+    }
+
+private:
+    // Tiles are addressed by their index in tiles_, which doesn't change when the pit scrolls. The tiles are stored a
+    // column at a time so that gravity walks through memory in order.
+    using Index = uint32_t;
+
+    size_t PitIndex(size_t x, size_t y) const
+    {
+        size_t row = y + firstRow_;
+        if (row >= rows_)
+        {
+            row -= rows_;
+        }
+        return row + x * rows_;
+    }
+
+    PitCoord CoordOf(Index i) const
+    {
+        const size_t row = i % rows_;
+        return PitCoord{static_cast<uint16_t>(i / rows_), static_cast<uint16_t>(row >= firstRow_ ? row - firstRow_ : row + rows_ - firstRow_)};
+    }
+
+    Tile& TileAt(size_t x, size_t y)
+    {
+        return tiles_[PitIndex(x, y)];
+    }
+
+    const Tile& TileAt(size_t x, size_t y) const
+    {
+        return tiles_[PitIndex(x, y)];
+    }
+
+    bool IsFilled(size_t x, size_t y) const
+    {
+        return y < rows_ && !TileAt(x, y).IsEmpty();
+    }
+
+    // A tile can be part of a run if it's a fully descended coloured tile.
+    bool IsSettled(size_t x, size_t y) const
+    {
+        const Tile& tile = TileAt(x, y);
+        return !tile.IsEmpty() && tile.IsMovableType() && tile.IsDescended();
+    }
+
+    bool LinksDown(size_t x, size_t y) const;
+    bool LinksRight(size_t x, size_t y) const;
+    bool IsInVerticalLine(size_t x, size_t y) const;
+    bool IsInHorizontalLine(size_t x, size_t y) const;
+
+    void MarkDirty(size_t x, size_t y);
+    void MarkActive(size_t x, size_t top, size_t bottom);
+    void MarkChained(Index i);
+    void SetChain(size_t x, size_t y, uint8_t chain);
+    void ClearTile(size_t x, size_t y);
+    void MoveDown(size_t x, size_t y);
+
+    void ApplyGravity();
+    void ApplyGravity(size_t x, bool& landed);
+    void CheckForRuns();
+    void LabelRun(size_t x, size_t y);
+    void RemoveRuns();
+    void RemoveDeadChains();
+
+    void Refill(size_t row);
+    void RefillRows(size_t numRows);
+
+    size_t cols_;
+    size_t rows_;
+    std::vector<Tile> tiles_;
+    std::vector<uint32_t> runIds_;     // The run that each tile belongs to, or 0. Tile::runId is too small for this pit.
+    std::vector<uint8_t> isDirty_;     // Tiles that are in dirty_.
+    std::vector<Index> dirty_;         // Tiles whose type or descended state changed since runs were last checked.
+    std::vector<uint8_t> isChained_;   // Tiles that are in chained_.
+    std::vector<Index> chained_;       // Tiles that may have a non-zero chain.
+    std::vector<size_t> activeTop_;    // The rows of each column that may have falling tiles or gaps under tiles.
+    std::vector<size_t> activeBottom_; // A column is at rest if its top is below its bottom.
+    std::vector<Index> pending_;       // Tiles waiting to be added to the run that is being labelled.
+    size_t firstRow_{0};
+    size_t level_{1};
+    uint64_t seed_;
+    UpcomingRows upcoming_;
+    bool impacted_{false};
+    bool landed_{false};
+    std::vector<RunRecord> runs_;      // Reserved up front, as are runCoords_, so that finding runs doesn't allocate.
+    std::vector<PitCoord> runCoords_;  // The coordinates of every run, one run after another.
+};
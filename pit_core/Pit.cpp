@@ -0,0 +1,1076 @@
+#include "Pit.h"
+
+#include "je/Logger.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#if defined(PIT_CHECK_INCREMENTAL)
+#include <cassert>
+#endif
+
+#define TILE_HEIGHT 15
+
+namespace
+{
+    // Calls f(i) for every i in [0, N), passing i as a compile-time constant. The pit's dimensions are known at compile
+    // time, so this fully unrolls the small loops over its columns and rows.
+    template<typename F, size_t... Is>
+    inline void Unroll(F&& f, std::index_sequence<Is...>)
+    {
+        (f(std::integral_constant<size_t, Is>{}), ...);
+    }
+
+    template<size_t N, typename F>
+    inline void Unroll(F&& f)
+    {
+        Unroll(std::forward<F>(f), std::make_index_sequence<N>{});
+    }
+
+    template<typename TGroups, typename TGroupId>
+    TGroupId FindGroup(TGroups& group, TGroupId i)
+    {
+        while (group[i] != i)
+        {
+            group[i] = group[group[i]];// Path halving.
+            i = group[i];
+        }
+        return i;
+    }
+
+    template<typename TGroups, typename TGroupId>
+    void JoinGroups(TGroups& group, TGroupId a, TGroupId b)
+    {
+        a = FindGroup(group, a);
+        b = FindGroup(group, b);
+        if (a != b)
+        {
+            // The lower index becomes the root.
+            group[std::max(a, b)] = std::min(a, b);
+        }
+    }
+} // namespace
+
+template<size_t Width, size_t Height, size_t NumColours>
+int BasicPit<Width, Height, NumColours>::LowerHeight(size_t x, size_t y)
+{
+    // Only falling tiles are lowered, and they're never empty, so only the height key changes.
+    auto& tile = TileAt(x, y);
+    hash_ ^= Zobrist::RotateLeft(tileKeys_.height[x][tile.height] ^ tileKeys_.height[x][tile.height - 1], y);
+    if (--tile.height == 0)
+    {
+        descendedMask_[x] |= RowBit(y);
+        dirtyMask_[x] |= RowBit(y);
+    }
+    return tile.height;
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+inline void BasicPit<Width, Height, NumColours>::MoveDown(size_t x, size_t y)
+{
+    ToggleHash(x, y);
+    ToggleHash(x, y - 1);
+    std::swap(TileAt(x, y), TileAt(x, y - 1));
+    TileAt(x, y).height = TILE_HEIGHT;
+    ToggleHash(x, y);
+    ToggleHash(x, y - 1);
+    SyncMasks(x, y);
+    SyncMasks(x, y - 1);
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::SyncMasks(size_t x, size_t y)
+{
+    // Bring the bitboards into line with the tile at the given position.
+    const Tile& tile = TileAt(x, y);
+    const ColumnMask bit = RowBit(y);
+    for (auto& mask : typeMasks_)
+    {
+        mask[x] &= static_cast<ColumnMask>(~bit);
+    }
+    TypeMask(tile.tileType)[x] |= bit;
+    if (tile.IsDescended())
+    {
+        descendedMask_[x] |= bit;
+    }
+    else
+    {
+        descendedMask_[x] &= static_cast<ColumnMask>(~bit);
+    }
+    if (tile.chain > 0)
+    {
+        chainMask_[x] |= bit;
+    }
+    else
+    {
+        chainMask_[x] &= static_cast<ColumnMask>(~bit);
+    }
+    dirtyMask_[x] |= bit;
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::RebuildMasks()
+{
+    for (auto& mask : typeMasks_)
+    {
+        mask.fill(0);
+    }
+    descendedMask_.fill(0);
+    chainMask_.fill(0);
+    for (size_t y = 0; y < rows; y++)
+    {
+        for (size_t x = 0; x < cols; x++)
+        {
+            SyncMasks(x, y);
+        }
+    }
+
+    // A slab's walls are as high as the slab is.
+    slabMask_.fill(0);
+    for (size_t i = 0; i < numSlabs_; i++)
+    {
+        const Slab& slab = slabs_[i];
+        for (size_t x = slab.x; x < slab.Right(); x++)
+        {
+            slabMask_[x] |= SlabRows(slab);
+            if (slab.fallHeight > 0)
+            {
+                descendedMask_[x] &= static_cast<ColumnMask>(~SlabRows(slab));
+            }
+        }
+    }
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+uint64_t BasicPit<Width, Height, NumColours>::FullHash() const
+{
+    uint64_t hash = 0;
+    for (size_t y = 0; y < rows; y++)
+    {
+        for (size_t x = 0; x < cols; x++)
+        {
+            hash ^= TileKey(x, y);
+        }
+    }
+    for (size_t i = 0; i < numSlabs_; i++)
+    {
+        hash ^= SlabKey(slabs_[i]);
+    }
+    return hash;
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+BasicPit<Width, Height, NumColours>::BasicPit(uint64_t seed)
+    : seed_{seed}, impacted_{false}, run_{0}
+{
+    std::fill(tiles_.begin(), tiles_.end(), Tile());
+    RebuildMasks();
+    hash_ = FullHash();
+    upcoming_.Reset(seed_, ColoursInPlay());
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::SetLevel(size_t level)
+{
+    level_ = level;
+    upcoming_.SetColours(ColoursInPlay());
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::Reset(size_t level, uint64_t seed)
+{
+    level_ = level;
+    seed_ = seed;
+    upcoming_.Reset(seed_, ColoursInPlay());
+    std::fill(tiles_.begin(), tiles_.end(), Tile());
+    numSlabs_ = 0;
+    RebuildMasks();
+    hash_ = FullHash();
+    RefillRows(rows / 2);
+    run_ = 0;
+    impacted_ = false;
+    landed_ = false;
+    numRuns_ = 0;
+    tick_ = 0;
+    garbage_ = false;
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::Refill(size_t row)
+{
+    const TileType* next = upcoming_.Peek();
+    for (size_t x = 0; x < cols; x++)
+    {
+        ToggleHash(x, row);
+        TileAt(x, row) = Tile(next[x]);
+        ToggleHash(x, row);
+        SyncMasks(x, row);
+    }
+    upcoming_.Pop();
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::RefillRows(int numRows)
+{
+    for (size_t row = rows - numRows; row != rows; row++)
+    {
+        Refill(row);
+    }
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::RefillBottomRow()
+{
+    RefillRows(1);
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::ScrollOne()
+{
+    // Every logical row moves up by one, so rotate the hash to match. The old top row wraps around to become the bottom
+    // row, so it's taken out of the hash before the rotation and put back in its new place after it.
+    uint64_t topRow = 0;
+    for (size_t x = 0; x < cols; x++)
+    {
+        topRow ^= TileKey(x, 0);
+    }
+
+    // A slab in the top row is about to lose that row, so it comes out of the hash until it has.
+    for (size_t i = 0; i < numSlabs_; i++)
+    {
+        if (slabs_[i].y == 0)
+        {
+            ToggleHash(slabs_[i]);
+        }
+    }
+    hash_ = Zobrist::RotateRight(hash_ ^ topRow, 1) ^ Zobrist::RotateLeft(topRow, rows - 1);
+
+    firstRow_ = (firstRow_ + 1) % rows;
+
+    // Every logical row moves up by one, so shift the bitboards to match. The old top row wraps around to become the
+    // bottom row, which is about to be refilled.
+    Unroll<cols>([this](auto x) {
+        for (auto& mask : typeMasks_)
+        {
+            mask[x] >>= 1;
+        }
+        descendedMask_[x] >>= 1;
+        chainMask_[x] >>= 1;
+        slabMask_[x] >>= 1;
+    });
+    RefillBottomRow();
+
+    // Every slab moves up a row too, which keeps them in order. A slab that was in the top row loses that row, as it
+    // has become the bottom row.
+    for (size_t i = numSlabs_; i-- > 0;)
+    {
+        Slab& slab = slabs_[i];
+        if (slab.y > 0)
+        {
+            --slab.y;
+        }
+        else if (slab.height == 1)
+        {
+            std::copy(slabs_.begin() + i + 1, slabs_.begin() + numSlabs_, slabs_.begin() + i);
+            --numSlabs_;
+            IndexSlabs(i, numSlabs_);
+        }
+        else
+        {
+            --slab.height;
+            ToggleHash(slab);
+        }
+    }
+
+    // Runs can form or break anywhere now that every row has moved.
+    dirtyMask_.fill(allRows);
+    Publish(Event::Type::RowScrolled);
+
+    // The pit is impacted if there are any non-empty tiles in the top row.
+    for (const auto column : EmptyMask())
+    {
+        if ((column & RowBit(0)) == 0)
+        {
+            if (!impacted_)
+            {
+                Publish(Event::Type::Impact);
+            }
+            impacted_ = true;
+            break;
+        }
+    }
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::Swap(size_t x, size_t y)
+{
+    auto& tile1 = tiles_[PitIndex(x, y)];
+    auto& tile2 = tiles_[PitIndex(x + 1, y)];
+    if (tile1.IsMovableType() && tile2.IsMovableType())
+    {
+        ToggleHash(x, y);
+        ToggleHash(x + 1, y);
+        std::swap(tile1, tile2);
+        ToggleHash(x, y);
+        ToggleHash(x + 1, y);
+        SyncMasks(x, y);
+        SyncMasks(x + 1, y);
+        Publish(Event::Type::Swap, x, y);
+    }
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::SetTile(size_t x, size_t y, TileType tileType, uint8_t height, uint8_t chain)
+{
+    RemoveSlabs(x, y, 1, 1);
+    ToggleHash(x, y);
+    Tile& tile = TileAt(x, y);
+    tile = Tile(tileType);
+    tile.height = height;
+    tile.chain = chain;
+    ToggleHash(x, y);
+    SyncMasks(x, y);
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+bool BasicPit<Width, Height, NumColours>::SetSlab(size_t x, size_t y, size_t width, size_t height, uint8_t fallHeight)
+{
+    if (numSlabs_ == maxSlabs)
+    {
+        return false;
+    }
+    RemoveSlabs(x, y, width, height);
+    for (size_t row = y; row < y + height; row++)
+    {
+        for (size_t col = x; col < x + width; col++)
+        {
+            ToggleHash(col, row);
+            Tile& tile = TileAt(col, row);
+            tile = Tile(TileType::Wall);
+            ToggleHash(col, row);
+            SyncMasks(col, row);
+        }
+    }
+
+    const Slab slab{static_cast<uint8_t>(x), static_cast<uint8_t>(y), static_cast<uint8_t>(width), static_cast<uint8_t>(height), fallHeight};
+    for (size_t col = x; col < x + width; col++)
+    {
+        slabMask_[col] |= SlabRows(slab);
+        if (fallHeight > 0)
+        {
+            descendedMask_[col] &= static_cast<ColumnMask>(~SlabRows(slab));
+        }
+    }
+    ToggleHash(slab);
+
+    // It goes after any slabs that are lower than it, or level with it.
+    size_t i = numSlabs_++;
+    for (; i > 0 && slabs_[i - 1].Bottom() < slab.Bottom(); i--)
+    {
+        slabs_[i] = slabs_[i - 1];
+    }
+    slabs_[i] = slab;
+    IndexSlabs(i, numSlabs_);
+    return true;
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+bool BasicPit<Width, Height, NumColours>::DropSlab(size_t x, size_t width, size_t height)
+{
+    // The slab goes just below the top row so that it doesn't impact the pit if it scrolls before the slab falls.
+    if (width == 0 || height == 0 || x + width > cols || height > rows - 2)
+    {
+        return false;
+    }
+    for (size_t y = 1; y <= height; y++)
+    {
+        for (size_t col = x; col < x + width; col++)
+        {
+            if (!IsEmpty(col, y))
+            {
+                return false;
+            }
+        }
+    }
+    return SetSlab(x, 1, width, height);
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::RemoveSlab(size_t i)
+{
+    // Its walls stay where they are, fixed in place and fully descended, unless the caller replaces them.
+    const Slab& slab = slabs_[i];
+    ToggleHash(slab);
+    for (size_t x = slab.x; x < slab.Right(); x++)
+    {
+        slabMask_[x] &= static_cast<ColumnMask>(~SlabRows(slab));
+        descendedMask_[x] |= SlabRows(slab);
+        for (size_t y = slab.y; y <= slab.Bottom(); y++)
+        {
+            TileAt(x, y).runId = 0;
+        }
+    }
+    std::copy(slabs_.begin() + i + 1, slabs_.begin() + numSlabs_, slabs_.begin() + i);
+    --numSlabs_;
+    IndexSlabs(i, numSlabs_);
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::IndexSlabs(size_t first, size_t last)
+{
+    // Tells the walls of the slabs from first up to last where their slabs now are in slabs_.
+    for (size_t i = first; i < last; i++)
+    {
+        const Slab& slab = slabs_[i];
+        for (size_t y = slab.y; y <= slab.Bottom(); y++)
+        {
+            for (size_t x = slab.x; x < slab.Right(); x++)
+            {
+                TileAt(x, y).runId = static_cast<uint8_t>(i);
+            }
+        }
+    }
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::RemoveSlabs(size_t x, size_t y, size_t width, size_t height)
+{
+    // Removes every slab that overlaps the given rectangle.
+    for (size_t i = numSlabs_; i-- > 0;)
+    {
+        const Slab& slab = slabs_[i];
+        if (slab.x < x + width && x < slab.Right() && slab.y < y + height && y <= slab.Bottom())
+        {
+            RemoveSlab(i);
+        }
+    }
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::DropGarbage()
+{
+    const uint32_t interval = Difficulty::GarbageIntervalForLevel(level_);
+    if ((tick_ + 1) % interval != 0)
+    {
+        return;
+    }
+
+    // The slab's size and where it drops are decided by the seed and the time, so that the game plays the same way
+    // every time. If there isn't room for it then it doesn't drop.
+    const uint64_t bits = Zobrist::Mix(seed_ ^ Zobrist::Mix(tick_));
+    const size_t width = 3 + bits % (cols - 2);
+    const size_t height = 1 + (bits >> 16) % Difficulty::GarbageRowsForLevel(level_);
+    const size_t x = (bits >> 32) % (cols - width + 1);
+    DropSlab(x, width, height);
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+typename BasicPit<Width, Height, NumColours>::Snapshot BasicPit<Width, Height, NumColours>::Save() const
+{
+    return Snapshot{tiles_, slabs_, numSlabs_, upcoming_, seed_, level_, firstRow_, tick_, impacted_, garbage_};
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::Restore(const Snapshot& snapshot)
+{
+    tiles_ = snapshot.tiles;
+    slabs_ = snapshot.slabs;
+    numSlabs_ = snapshot.numSlabs;
+    upcoming_ = snapshot.upcoming;
+    seed_ = snapshot.seed;
+    level_ = snapshot.level;
+    firstRow_ = snapshot.firstRow;
+    tick_ = snapshot.tick;
+    impacted_ = snapshot.impacted;
+    garbage_ = snapshot.garbage;
+    landed_ = false;
+    run_ = 0;
+    numRuns_ = 0;
+
+    // Every tile is marked as dirty, so the next update checks the whole pit for runs. That finds the same runs as the
+    // pit that was saved would have, because runs are removed as soon as they form.
+    RebuildMasks();
+    hash_ = FullHash();
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::Update()
+{
+    if (garbage_)
+    {
+        DropGarbage();
+    }
+
+#if defined(PIT_CHECK_INCREMENTAL)
+    // Update a copy of the pit the slow way, rebuilding its bitboards from the tiles and looking at every tile.
+    BasicPit full{*this};
+    full.RebuildMasks();
+    full.fullUpdate_ = true;
+    full.ApplyGravity();
+    full.CheckForRuns();
+    full.RemoveRuns();
+    full.RemoveDeadChains();
+#endif
+
+    ApplyGravity();
+    CheckForRuns();
+    RemoveRuns();
+    RemoveDeadChains();
+    if (landed_)
+    {
+        Publish(Event::Type::Land);
+    }
+    ++tick_;
+
+#if defined(PIT_CHECK_INCREMENTAL)
+    CheckAgainst(full);
+#endif
+}
+
+#if defined(PIT_CHECK_INCREMENTAL)
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::CheckAgainst(const BasicPit& full) const
+{
+    bool same = landed_ == full.landed_ && numRuns_ == full.numRuns_
+                && typeMasks_ == full.typeMasks_ && descendedMask_ == full.descendedMask_ && chainMask_ == full.chainMask_
+                && slabMask_ == full.slabMask_ && numSlabs_ == full.numSlabs_ && hash_ == full.hash_ && hash_ == FullHash();
+    for (size_t i = 0; same && i < numSlabs_; i++)
+    {
+        same = SlabKey(slabs_[i]) == SlabKey(full.slabs_[i]);
+        for (size_t y = slabs_[i].y; same && y <= slabs_[i].Bottom(); y++)
+        {
+            for (size_t x = slabs_[i].x; same && x < slabs_[i].Right(); x++)
+            {
+                same = TileAt(x, y).runId == i;
+            }
+        }
+    }
+    for (size_t i = 0; same && i < numRuns_; i++)
+    {
+        same = runs_[i].runSize == full.runs_[i].runSize && runs_[i].chainLength == full.runs_[i].chainLength;
+    }
+    for (size_t y = 0; same && y < rows; y++)
+    {
+        for (size_t x = 0; same && x < cols; x++)
+        {
+            const Tile& tile = TileAt(x, y);
+            const Tile& fullTile = full.TileAt(x, y);
+            same = tile.tileType == fullTile.tileType && tile.height == fullTile.height && tile.chain == fullTile.chain;
+        }
+    }
+    if (!same)
+    {
+        LOG("Incremental update of the pit differs from a full update");
+        assert(false);
+    }
+}
+#endif
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::ApplyGravity()
+{
+    // Only columns with falling tiles or with empty squares under fully descended squares need gravity. Everything
+    // else is settled. Note that empty squares are movable, so they take part too.
+    bool landed = false;
+    if (numSlabs_ > 0)
+    {
+        ApplySlabGravity(landed);
+    }
+    Unroll<cols>([this, &landed](auto x) {
+        const ColumnMask movable = allRows & ~WallMask()[x];
+        const ColumnMask falling = movable & FilledColumn(x) & ~descendedMask_[x];
+        const ColumnMask gaps = EmptyMask()[x] & ((movable & descendedMask_[x]) << 1);
+        if (fullUpdate_ || ((falling | gaps) & innerRows) != 0)
+        {
+            ApplyGravity(x, landed);
+        }
+    });
+    landed_ = landed;
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+bool BasicPit<Width, Height, NumColours>::IsSettled() const
+{
+    // This asks the same question as ApplyGravity() does of each column.
+    for (size_t x = 0; x < cols; x++)
+    {
+        const ColumnMask movable = allRows & ~WallMask()[x];
+        const ColumnMask falling = movable & FilledColumn(x) & ~descendedMask_[x];
+        const ColumnMask gaps = EmptyMask()[x] & ((movable & descendedMask_[x]) << 1);
+        const ColumnMask slabs = SlabColumn(x);
+        const ColumnMask slabsFalling = (slabs & ~descendedMask_[x]) | (EmptyMask()[x] & (slabs << 1));
+        if (((falling | gaps | slabsFalling) & innerRows) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::ApplyGravity(size_t x, bool& landed)
+{
+    // Work up the column from the second row from the bottom to the second row from the top.
+    Unroll<rows - 2>([this, x, &landed](auto i) {
+        constexpr size_t y = rows - 2 - decltype(i)::value;
+
+        // If the current square is empty and the one above contains a tile that is fully descended then move it
+        // down to this square.
+        if (IsEmpty(x, y))
+        {
+            if (IsMovableType(x, y - 1) && IsDescended(x, y - 1))
+            {
+                MoveDown(x, y);
+            }
+        }
+
+        // If a tile is not fully descended then bring it down.
+        if (!IsEmpty(x, y) && IsMovableType(x, y) && !IsDescended(x, y))
+        {
+            // Did the tile just fully descend onto a non-empty tile?
+            if (LowerHeight(x, y) == 0 && !IsEmpty(x, y + 1))
+            {
+                // If the non-empty tile is either not movable, or is descended itself, then the tile just landed.
+                if (!IsMovableType(x, y + 1) || IsDescended(x, y + 1))
+                {
+                    landed = true;
+                }
+            }
+        }
+    });
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::ApplySlabGravity(bool& landed)
+{
+    // Only slabs that are falling, or that have a gap under them, need gravity, and the bitboards say whether there
+    // are any without looking at each slab. A pit full of garbage that has settled costs no more than an empty one.
+    ColumnMask unsettled = 0;
+    Unroll<cols>([&](auto x) {
+        const ColumnMask slabs = SlabColumn(x);
+        unsettled |= (slabs & ~descendedMask_[x]) | (EmptyMask()[x] & (slabs << 1) & innerRows);
+    });
+    if (unsettled == 0 && !fullUpdate_)
+    {
+        return;
+    }
+
+    // Work up from the lowest slab, so that a stack of slabs falls together as a stack of tiles does.
+    for (size_t i = 0; i < numSlabs_; i++)
+    {
+        Slab& slab = slabs_[i];
+        if (slab.fallHeight > 0)
+        {
+            LowerSlab(slab, landed);
+            continue;
+        }
+
+        // A slab that has fully descended moves down a row if there's nothing under any of it.
+        bool gap = slab.Bottom() + 1 < rows - 1;
+        for (size_t x = slab.x; gap && x < slab.Right(); x++)
+        {
+            gap = IsEmpty(x, slab.Bottom() + 1);
+        }
+        if (!gap)
+        {
+            continue;
+        }
+        MoveSlabDown(slab);
+        LowerSlab(slab, landed);
+
+        // It's now lower than the slabs that were level with it, so it goes before them to keep the slabs in order.
+        size_t j = i;
+        for (; j > 0 && slabs_[j - 1].Bottom() < slabs_[j].Bottom(); j--)
+        {
+            std::swap(slabs_[j - 1], slabs_[j]);
+        }
+        if (j < i)
+        {
+            IndexSlabs(j, i + 1);
+        }
+    }
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::MoveSlabDown(Slab& slab)
+{
+    // Each of the slab's columns moves down a row by swapping the wall at its top with the gap under it, as its walls
+    // are all alike. Empty tiles have no key, so only the wall that moves changes the hash.
+    const size_t top = slab.y;
+    const size_t below = slab.Bottom() + 1;
+    const auto swapped = static_cast<ColumnMask>(RowBit(top) | RowBit(below));
+    const auto falling = static_cast<ColumnMask>(SlabRows(slab) << 1);
+    const auto moveGap = [&](ColumnMask mask) {
+        return static_cast<ColumnMask>((mask & ~swapped) | ((mask >> slab.height) & RowBit(top)));
+    };
+    ToggleHash(slab);
+    for (size_t x = slab.x; x < slab.Right(); x++)
+    {
+        ToggleHash(x, top);
+        std::swap(TileAt(x, top), TileAt(x, below));
+        ToggleHash(x, below);
+
+        // They swap places in the bitboards too. The gap takes whether it has descended, and its chain, with it, walls
+        // never have a chain, and the slab starts to fall into its new row.
+        TypeMask(TileType::Wall)[x] ^= swapped;
+        TypeMask(TileType::None)[x] ^= swapped;
+        slabMask_[x] ^= swapped;
+        descendedMask_[x] = static_cast<ColumnMask>(moveGap(descendedMask_[x]) & ~falling);
+        chainMask_[x] = moveGap(chainMask_[x]);
+        dirtyMask_[x] |= swapped;
+    }
+    ++slab.y;
+    slab.fallHeight = TILE_HEIGHT;
+    ToggleHash(slab);
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::LowerSlab(Slab& slab, bool& landed)
+{
+    // The slab comes down as a whole, so only its height key changes. Its walls have no height of their own, but
+    // they're only marked as descended once it has fully descended.
+    const auto& keys = tileKeys_.slabHeight[slab.x];
+    hash_ ^= Zobrist::RotateLeft(keys[slab.fallHeight] ^ keys[slab.fallHeight - 1], slab.y);
+    --slab.fallHeight;
+    if (slab.fallHeight > 0)
+    {
+        return;
+    }
+    for (size_t x = slab.x; x < slab.Right(); x++)
+    {
+        descendedMask_[x] |= SlabRows(slab);
+        dirtyMask_[x] |= SlabRows(slab);
+    }
+
+    // Did it just fully descend onto something that isn't falling?
+    const size_t below = slab.Bottom() + 1;
+    for (size_t x = slab.x; !landed && below < rows && x < slab.Right(); x++)
+    {
+        landed = !IsEmpty(x, below) && (!IsMovableType(x, below) || IsDescended(x, below));
+    }
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::BreakSlabs(const Bitboard& cleared)
+{
+    // A slab breaks if any of it is next to a tile that was cleared.
+    Bitboard touched;
+    for (size_t x = 0; x < cols; x++)
+    {
+        ColumnMask next = static_cast<ColumnMask>((cleared[x] << 1) | (cleared[x] >> 1));
+        next |= (x > 0) ? cleared[x - 1] : 0;
+        next |= (x + 1 < cols) ? cleared[x + 1] : 0;
+        touched[x] = next & SlabColumn(x);
+    }
+    for (size_t i = numSlabs_; i-- > 0;)
+    {
+        const Slab slab = slabs_[i];
+        bool touches = false;
+        for (size_t x = slab.x; x < slab.Right(); x++)
+        {
+            touches = touches || (touched[x] & SlabRows(slab)) != 0;
+        }
+        if (touches)
+        {
+            RemoveSlab(i);
+            BreakSlab(slab);
+        }
+    }
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::BreakSlab(const Slab& slab)
+{
+    // The slab turns into tiles where it is, as high as it is, which then fall like any others.
+    for (size_t y = slab.y; y <= slab.Bottom(); y++)
+    {
+        for (size_t x = slab.x; x < slab.Right(); x++)
+        {
+            const TileType left = (x > slab.x) ? TileTypeAt(x - 1, y) : TileType::None;
+            const TileType above = (y > slab.y) ? TileTypeAt(x, y - 1) : TileType::None;
+            ToggleHash(x, y);
+            Tile& tile = TileAt(x, y);
+            tile = Tile(BrokenTile(x, y, left, above));
+            tile.height = slab.fallHeight;
+            ToggleHash(x, y);
+            SyncMasks(x, y);
+        }
+    }
+    Publish(Event::Type::SlabBroken, slab.x, slab.y, 0, size_t{slab.width} * slab.height);
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+typename BasicPit<Width, Height, NumColours>::TileType BasicPit<Width, Height, NumColours>::BrokenTile(size_t x, size_t y, TileType left, TileType above) const
+{
+    // The colour is decided by the seed, the time and the position, and isn't the same as the tile to its left or the
+    // tile above it, so that a slab doesn't break into runs of its own.
+    const size_t colours = ColoursInPlay();
+    size_t colour = Zobrist::Mix(seed_ ^ Zobrist::Mix((uint64_t{tick_} << 16u) | (y << 8u) | x)) % colours;
+    for (size_t i = 0; i < 2 && (tileColours[colour] == left || tileColours[colour] == above); i++)
+    {
+        colour = (colour + 1) % colours;
+    }
+    return tileColours[colour];
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::FindRunLinks(Bitboard& down, Bitboard& right) const
+{
+    // Two tiles are linked if they're fully descended tiles of the same colour that would both be part of a run if
+    // either of them was. A vertical pair is linked if the tile below the pair is non-empty, and a horizontal pair is
+    // linked if the tiles below both of them are non-empty.
+    Bitboard filled;
+    Bitboard supported;
+    Unroll<cols>([&](auto x) {
+        // A tile is supported if the tile below it is non-empty. This wraps from the bottom row to the top row, as
+        // PitIndex() does.
+        filled[x] = FilledColumn(x);
+        supported[x] = static_cast<ColumnMask>((filled[x] >> 1) | ((filled[x] & 1) << (rows - 1)));
+    });
+
+    down.fill(0);
+    right.fill(0);
+    Unroll<numColours>([&](auto colour) {
+        // Only fully descended tiles can be part of a run.
+        const Bitboard& typeMask = TypeMask(tileColours[colour]);
+        Bitboard settled;
+        Unroll<cols>([&](auto x) {
+            settled[x] = typeMask[x] & descendedMask_[x];
+        });
+
+        // Bit y of down[x] links (x, y) to (x, y + 1).
+        Unroll<cols>([&](auto x) {
+            down[x] |= settled[x] & (settled[x] >> 1) & (filled[x] >> 2);
+        });
+
+        // Bit y of right[x] links (x, y) to (x + 1, y).
+        Unroll<cols - 1>([&](auto x) {
+            right[x] |= settled[x] & settled[x + 1] & supported[x] & supported[x + 1];
+        });
+    });
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::LabelRuns(const Bitboard& down, const Bitboard& right, const Bitboard& verticalSeeds, const Bitboard& horizontalSeeds)
+{
+    // Join linked tiles into groups in a single pass.
+    std::array<GroupId, cols * rows> group;
+    std::iota(group.begin(), group.end(), GroupId{0});
+    for (size_t y = 0; y < rows; y++)
+    {
+        for (size_t x = 0; x < cols; x++)
+        {
+            const auto i = static_cast<GroupId>(x + y * cols);
+            if ((down[x] & RowBit(y)) != 0)
+            {
+                JoinGroups(group, i, static_cast<GroupId>(i + cols));
+            }
+            if ((right[x] & RowBit(y)) != 0)
+            {
+                JoinGroups(group, i, static_cast<GroupId>(i + 1));
+            }
+        }
+    }
+
+    // A group is a run if it contains 3 matching tiles in a line. Number the runs in the order that they're found,
+    // looking for vertical runs before horizontal runs.
+    std::array<uint8_t, cols * rows> groupRun{};
+    for (size_t y = 0; y < rows - 3; y++)
+    {
+        for (size_t x = 0; x < cols; x++)
+        {
+            if ((verticalSeeds[x] & RowBit(y)) != 0)
+            {
+                if (auto& run = groupRun[FindGroup(group, static_cast<GroupId>(x + y * cols))]; run == 0)
+                {
+                    run = static_cast<uint8_t>(run_++);
+                }
+            }
+        }
+    }
+    for (size_t x = 0; x < cols - 2; x++)
+    {
+        for (size_t y = 0; y < rows; y++)
+        {
+            if ((horizontalSeeds[x] & RowBit(y)) != 0)
+            {
+                if (auto& run = groupRun[FindGroup(group, static_cast<GroupId>(x + y * cols))]; run == 0)
+                {
+                    run = static_cast<uint8_t>(run_++);
+                }
+            }
+        }
+    }
+
+    // Every tile in a run's group is part of that run. Walls never are, and keep their slab's index instead.
+    for (size_t y = 0; y < rows; y++)
+    {
+        for (size_t x = 0; x < cols; x++)
+        {
+            if (Tile& tile = TileAt(x, y); tile.IsMovableType())
+            {
+                tile.runId = groupRun[FindGroup(group, static_cast<GroupId>(x + y * cols))];
+            }
+        }
+    }
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::CheckForRuns()
+{
+    // Look for runs of tiles of the same colour that are at least 3 tiles horizontally or vertically, along with any
+    // matching tiles that are connected to them.
+    run_ = 1;
+
+    // Any new run must include a tile that changed since the last check, because runs are removed as soon as they're
+    // found. If nothing has changed then there can't be any runs.
+    ColumnMask anyDirty = 0;
+    Unroll<cols>([&](auto x) {
+        anyDirty |= dirtyMask_[x];
+    });
+    if (anyDirty == 0 && !fullUpdate_)
+    {
+        return;
+    }
+    dirtyMask_.fill(0);
+
+    // A run starts wherever there are 3 linked tiles in a line. There's nothing more to do if there aren't any.
+    Bitboard down;
+    Bitboard right;
+    FindRunLinks(down, right);
+    Bitboard verticalSeeds{};
+    Bitboard horizontalSeeds{};
+    ColumnMask anySeeds = 0;
+    Unroll<cols>([&](auto x) {
+        verticalSeeds[x] = down[x] & (down[x] >> 1);
+        anySeeds |= verticalSeeds[x];
+    });
+    Unroll<cols - 2>([&](auto x) {
+        horizontalSeeds[x] = right[x] & right[x + 1];
+        anySeeds |= horizontalSeeds[x];
+    });
+    if (anySeeds == 0)
+    {
+        return;
+    }
+
+    LabelRuns(down, right, verticalSeeds, horizontalSeeds);
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::RemoveRuns()
+{
+    numRuns_ = run_ - 1;
+
+    // There were no runs detected.
+    if (numRuns_ == 0)
+    {
+        return;
+    }
+
+#if !defined(NDEBUG)
+    // Output some debug to show the pit. Release builds leave it out, as they may be running thousands of pits at once.
+    LOG("There are " << numRuns_ << " runs");
+    for (size_t y = 0; y < rows; y++)
+    {
+        std::array<char, cols + 1> row{};
+        for (size_t x = 0; x < cols; x++)
+        {
+            const auto run = RunAt(x, y);
+            row[x] = run > 0 ? static_cast<char>('0' + run) : '.';
+        }
+        LOG(row.data());
+    }
+#endif
+
+    // Find the size and the maximum chain length of each run.
+    std::fill(runs_.begin(), runs_.begin() + numRuns_, RunRecord{});
+    std::array<PitCoord, maxRuns> firstTiles;
+    for (size_t y = 0; y < rows; y++)
+    {
+        for (size_t x = 0; x < cols; x++)
+        {
+            if (auto run = RunAt(x, y); run > 0)
+            {
+                auto& runRecord = runs_[run - 1];
+                if (runRecord.runSize++ == 0)
+                {
+                    firstTiles[run - 1] = PitCoord{static_cast<uint16_t>(x), static_cast<uint16_t>(y)};
+                }
+                runRecord.chainLength = std::max<size_t>(runRecord.chainLength, ChainAt(x, y));
+            }
+        }
+    }
+
+    // Give each run its own part of runCoords_.
+    uint32_t first = 0;
+    for (size_t i = 0; i < numRuns_; i++)
+    {
+        runs_[i].first = first;
+        first += runs_[i].runSize;
+        Publish(Event::Type::RunFormed, firstTiles[i].x, firstTiles[i].y, runs_[i].chainLength, runs_[i].runSize, i);
+    }
+
+    // Clear all of the runs.
+    std::array<uint32_t, maxRuns> cleared{};
+    Bitboard clearedMask{};
+    for (size_t y = 0; y < rows; y++)
+    {
+        for (size_t x = 0; x < cols; x++)
+        {
+            if (auto run = RunAt(x, y); run > 0)
+            {
+                const auto& runRecord = runs_[run - 1];
+                runCoords_[runRecord.first + cleared[run - 1]++] = PitCoord{static_cast<uint16_t>(x), static_cast<uint16_t>(y)};
+                ClearTile(x, y);
+                clearedMask[x] |= RowBit(y);
+
+                // If there's a fully descended block in the row above then set its chain count to one more than the
+                // maximum chain length for this run. Empty squares pass the test too, and take the chain as they always
+                // have, but only a tile that's there is reported.
+                if (y > 0)
+                {
+                    if (IsMovableType(x, y - 1) && IsDescended(x, y - 1))
+                    {
+                        const auto chain = static_cast<uint8_t>(std::min<size_t>(runRecord.chainLength + 1, UINT8_MAX));
+                        SetChain(x, y - 1, chain);
+                        if (!IsEmpty(x, y - 1))
+                        {
+                            Publish(Event::Type::ChainExtended, x, y - 1, chain);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < numRuns_; i++)
+    {
+        Publish(Event::Type::RunCleared, firstTiles[i].x, firstTiles[i].y, runs_[i].chainLength, runs_[i].runSize, i);
+    }
+
+    if (numSlabs_ > 0)
+    {
+        BreakSlabs(clearedMask);
+    }
+}
+
+template<size_t Width, size_t Height, size_t NumColours>
+void BasicPit<Width, Height, NumColours>::RemoveDeadChains()
+{
+    Unroll<cols>([this](auto x) {
+        // Reset the chain of any fully descended block that is blocked below by a fully descended block.
+        const ColumnMask blocked = FilledColumn(x) & descendedMask_[x];
+        ColumnMask dead = chainMask_[x] & ~WallMask()[x] & descendedMask_[x] & (blocked >> 1);
+        for (size_t y = 0; dead != 0; y++, dead >>= 1)
+        {
+            if ((dead & 1) != 0)
+            {
+                SetChain(x, y, 0);
+            }
+        }
+    });
+}
+
+template class BasicPit<6, 13, 6>;
@@ -0,0 +1,458 @@
+#pragma once
+
+#include "Difficulty.h"
+#include "EventRing.h"
+#include "PitTypes.h"
+#include "RowQueue.h"
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// A pit with its dimensions and number of colours fixed at compile time, so that its loops have constant bounds.
+template<size_t Width, size_t Height, size_t NumColours>
+class BasicPit : public PitTypes
+{
+public:
+    static constexpr size_t cols = Width;
+    static constexpr size_t rows = Height;
+    static constexpr size_t numColours = NumColours;
+
+    static_assert(cols >= 3, "A pit must be wide enough for a horizontal run");
+    static_assert(rows >= 4 && rows <= 64, "A column of the pit must fit in a ColumnMask");
+    static_assert(numColours >= 3 && numColours <= 6, "Refilling needs at least 3 colours to avoid adjacent duplicates");
+    static_assert(cols * rows / 3 <= UINT8_MAX, "Every run in the pit must have a Tile::runId");
+    static_assert(cols <= UINT8_MAX && cols * rows <= UINT16_MAX, "An Event must be able to describe every tile and run");
+
+    // The rows that will scroll into the bottom of the pit, as far ahead as the pit is deep.
+    using UpcomingRows = RowQueue<cols, rows>;
+
+    // Enough room for everything that can happen in an update, with space to spare for a consumer that's behind. The
+    // pit doesn't have one of its own, so that a pit that's played headlessly doesn't carry one around.
+    using EventQueue = EventRing<Event, 256>;
+
+    // The slabs that drop into the pit are at least 3 tiles wide, so there's never more than this many of them in play.
+    static constexpr size_t maxSlabs = cols * rows / 3;
+
+    // Everything that decides how the pit plays from here on, but not the runs and events that describe its last
+    // update or the bitboards, which can be rebuilt from the tiles and slabs. It's a fraction of the size of the pit, so
+    // a search can save and restore positions cheaply.
+    struct Snapshot
+    {
+        std::array<Tile, cols * rows> tiles;
+        std::array<Slab, maxSlabs> slabs;
+        size_t numSlabs;
+        UpcomingRows upcoming;
+        uint64_t seed;
+        size_t level;
+        size_t firstRow;
+        uint32_t tick;
+        bool impacted;
+        bool garbage;
+    };
+
+public:
+    explicit BasicPit(uint64_t seed = 0);
+
+    // Starts a new game at the given level. The seed decides which tiles refill the pit.
+    void Reset(size_t level, uint64_t seed);
+    void SetLevel(size_t level);
+    void Update();
+    void ScrollOne();
+    void Swap(size_t x, size_t y);
+
+    // Replaces the tile at the given position, e.g., to set up a pit from a saved board. If it was part of a slab of
+    // garbage then the rest of the slab's walls are left fixed in place.
+    void SetTile(size_t x, size_t y, TileType tileType, uint8_t height = 0, uint8_t chain = 0);
+
+    // Replaces the tiles in the given rectangle, whose top left is at (x, y), with a slab of garbage. A slab falls and
+    // lands as one, and breaks into coloured tiles when a run is cleared next to it. Any slab that it overlaps is left as
+    // fixed walls, as SetTile() does. Returns false, and does nothing, if the pit already has maxSlabs slabs.
+    bool SetSlab(size_t x, size_t y, size_t width, size_t height, uint8_t fallHeight = 0);
+
+    // Drops a slab of garbage into the pit just below the top row, if there's room for it there.
+    bool DropSlab(size_t x, size_t width, size_t height);
+
+    // Whether slabs of garbage drop into the pit as often as its level says, as they do in endless mode. Reset() turns
+    // it off.
+    void SetGarbage(bool garbage)
+    {
+        garbage_ = garbage;
+    }
+
+    Snapshot Save() const;
+
+    // Puts the pit back as it was when the snapshot was saved. Its runs are forgotten, and its events are left alone.
+    void Restore(const Snapshot& snapshot);
+
+    // The walls of a falling slab of garbage are as high as the slab is.
+    int HeightAt(size_t x, size_t y) const
+    {
+        if ((slabMask_[x] & RowBit(y)) != 0)
+        {
+            return SlabAt(x, y).fallHeight;
+        }
+        return tiles_[PitIndex(x, y)].height;
+    }
+
+    TileType TileTypeAt(size_t x, size_t y) const
+    {
+        return tiles_[PitIndex(x, y)].tileType;
+    }
+
+    uint8_t ChainAt(size_t x, size_t y) const
+    {
+        return tiles_[PitIndex(x, y)].chain;
+    }
+
+    uint64_t Seed() const
+    {
+        return seed_;
+    }
+
+    const UpcomingRows& Upcoming() const
+    {
+        return upcoming_;
+    }
+
+    // The number of updates since the pit was reset.
+    uint32_t Tick() const
+    {
+        return tick_;
+    }
+
+    // Publishes what happens in the pit to a queue that belongs to the caller, which can drain it after each update or
+    // from another thread. Events are dropped if there's no queue, and a copy of the pit starts out without one.
+    void AttachEvents(EventQueue* events)
+    {
+        events_.queue = events;
+    }
+
+    // A hash of every tile's type, height and chain, keyed by where it is on the screen, which is everything about the
+    // tiles that affects how the pit plays from here on. It's kept up to date as the tiles change rather than worked
+    // out when it's asked for.
+    uint64_t Hash() const
+    {
+        return hash_;
+    }
+
+    bool IsImpacted() const
+    {
+        return impacted_;
+    }
+    bool Landed() const
+    {
+        return landed_;
+    }
+
+    // Whether nothing in the pit is falling, so that it won't change again until it's swapped or scrolled. Runs are
+    // removed by the update that finds them, so this only says whether there are runs to come after an update.
+    bool IsSettled() const;
+    RunView Runs() const
+    {
+        return RunView(runs_.data(), numRuns_, runCoords_.data());
+    }
+
+private:
+    friend class PitBenchmark;// Times each stage of Update() separately.
+
+    // A bitboard holds one bit per tile. Each column is a mask where bit y is set for logical row y, so vertical
+    // neighbours are a shift apart and horizontal neighbours are in adjacent columns.
+    using ColumnMask = std::conditional_t<(rows <= 16), uint16_t, std::conditional_t<(rows <= 32), uint32_t, uint64_t>>;
+    using Bitboard = std::array<ColumnMask, cols>;
+
+    static constexpr ColumnMask allRows = static_cast<ColumnMask>(std::numeric_limits<ColumnMask>::max() >> (std::numeric_limits<ColumnMask>::digits - rows));
+    static constexpr size_t numTileTypes = static_cast<size_t>(TileType::Wall) + 1;
+    static constexpr size_t maxRuns = cols * rows / 3;
+
+    // Identifies a group of linked tiles when labelling runs.
+    using GroupId = std::conditional_t<(cols * rows <= 256), uint8_t, uint16_t>;
+
+    static constexpr ColumnMask RowBit(size_t y)
+    {
+        return static_cast<ColumnMask>(ColumnMask{1} << y);
+    }
+
+    // Every row but the top and bottom rows, which tiles never fall from or into.
+    static constexpr ColumnMask innerRows = static_cast<ColumnMask>(allRows & ~RowBit(0) & ~RowBit(rows - 1));
+
+    const Bitboard& TypeMask(TileType tileType) const
+    {
+        return typeMasks_[static_cast<size_t>(tileType)];
+    }
+
+    Bitboard& TypeMask(TileType tileType)
+    {
+        return typeMasks_[static_cast<size_t>(tileType)];
+    }
+
+    const Bitboard& EmptyMask() const
+    {
+        return TypeMask(TileType::None);
+    }
+
+    const Bitboard& WallMask() const
+    {
+        return TypeMask(TileType::Wall);
+    }
+
+    ColumnMask FilledColumn(size_t x) const
+    {
+        return static_cast<ColumnMask>(~EmptyMask()[x] & allRows);
+    }
+
+    ColumnMask SlabColumn(size_t x) const
+    {
+        return slabMask_[x];
+    }
+
+    // The rows of a column that a slab covers.
+    static ColumnMask SlabRows(const Slab& slab)
+    {
+        return static_cast<ColumnMask>((allRows >> (rows - slab.height)) << slab.y);
+    }
+
+    // The slab that covers the given wall, which must be part of one. Its walls keep its index, so it's found directly.
+    const Slab& SlabAt(size_t x, size_t y) const
+    {
+        const size_t i = TileAt(x, y).runId;
+        assert(i < numSlabs_ && slabs_[i].Covers(x, y));
+        return slabs_[i];
+    }
+
+    void SyncMasks(size_t x, size_t y);
+    void RebuildMasks();
+
+    // Every key for every column, worked out at compile time so that looking one up is cheap.
+    struct TileKeys
+    {
+        std::array<std::array<uint64_t, numTileTypes>, cols> type;
+        std::array<std::array<uint64_t, UINT8_MAX + 1>, cols> chain;
+        std::array<std::array<uint64_t, UINT8_MAX + 1>, cols> height;
+        std::array<std::array<uint64_t, UINT8_MAX + 1>, cols> slabHeight;
+    };
+
+    static constexpr TileKeys tileKeys_ = [] {
+        TileKeys tileKeys{};
+        for (size_t x = 0; x < cols; x++)
+        {
+            for (size_t i = 0; i < numTileTypes; i++)
+            {
+                tileKeys.type[x][i] = Zobrist::TypeKey(x, static_cast<uint8_t>(i));
+            }
+            for (size_t i = 0; i <= UINT8_MAX; i++)
+            {
+                tileKeys.chain[x][i] = Zobrist::ChainKey(x, static_cast<uint8_t>(i));
+                tileKeys.height[x][i] = Zobrist::HeightKey(x, static_cast<uint8_t>(i));
+                tileKeys.slabHeight[x][i] = Zobrist::SlabHeightKey(x, static_cast<uint8_t>(i));
+            }
+        }
+        return tileKeys;
+    }();
+
+    // A tile's key is its key for the top row rotated left by its row, so that scrolling is a rotation of the hash.
+    // Empty tiles have no key, as nothing about them affects play.
+    uint64_t TileKey(size_t x, size_t y) const
+    {
+        const Tile& tile = TileAt(x, y);
+        if (tile.IsEmpty())
+        {
+            return 0;
+        }
+        const uint64_t key = tileKeys_.type[x][static_cast<size_t>(tile.tileType)] ^ tileKeys_.chain[x][tile.chain] ^ tileKeys_.height[x][tile.height];
+        return Zobrist::RotateLeft(key, y);
+    }
+
+    // Takes the tile at the given position out of the hash, or puts it back in. Call it before and after changing a
+    // tile.
+    void ToggleHash(size_t x, size_t y)
+    {
+        hash_ ^= TileKey(x, y);
+    }
+
+    // A slab's key is rotated by its top row in the same way as a tile's.
+    static uint64_t SlabKey(const Slab& slab)
+    {
+        const uint64_t key = Zobrist::SlabKey(slab.x, slab.width, slab.height) ^ tileKeys_.slabHeight[slab.x][slab.fallHeight];
+        return Zobrist::RotateLeft(key, slab.y);
+    }
+
+    void ToggleHash(const Slab& slab)
+    {
+        hash_ ^= SlabKey(slab);
+    }
+
+    uint64_t FullHash() const;
+
+    // The start of each row in tiles_, indexed by logical row plus firstRow_. The table covers two trips around the
+    // ring so that looking up a row doesn't need a modulo.
+    using RowStarts = std::array<size_t, 2 * rows>;
+
+    static constexpr RowStarts rowStarts_ = [] {
+        RowStarts rowStarts{};
+        for (size_t i = 0; i < rowStarts.size(); i++)
+        {
+            rowStarts[i] = (i % rows) * cols;
+        }
+        return rowStarts;
+    }();
+
+    size_t PitIndex(size_t x, size_t y) const
+    {
+        return x + rowStarts_[y + firstRow_];
+    }
+
+    Tile& TileAt(size_t x, size_t y)
+    {
+        return tiles_[PitIndex(x, y)];
+    }
+
+    const Tile& TileAt(size_t x, size_t y) const
+    {
+        return tiles_[PitIndex(x, y)];
+    }
+
+    void ClearTile(size_t x, size_t y)
+    {
+        ToggleHash(x, y);// An empty tile has no key, so there's nothing to put back.
+        TileAt(x, y) = Tile{};
+        SyncMasks(x, y);
+    }
+
+    uint8_t RunAt(size_t x, size_t y) const
+    {
+        const Tile& tile = TileAt(x, y);
+        return tile.IsInRun() ? tile.runId : 0;
+    }
+
+    void SetChain(size_t x, size_t y, uint8_t chain)
+    {
+        ToggleHash(x, y);
+        TileAt(x, y).chain = chain;
+        ToggleHash(x, y);
+        if (chain > 0)
+        {
+            chainMask_[x] |= RowBit(y);
+        }
+        else
+        {
+            chainMask_[x] &= static_cast<ColumnMask>(~RowBit(y));
+        }
+    }
+
+    bool IsEmpty(size_t x, size_t y) const
+    {
+        return TileAt(x, y).IsEmpty();
+    }
+
+    bool IsMovableType(size_t x, size_t y) const
+    {
+        return TileAt(x, y).IsMovableType();
+    }
+
+    bool IsFixedType(size_t x, size_t y) const
+    {
+        return TileAt(x, y).IsFixedType();
+    }
+
+    bool IsInRun(size_t x, size_t y) const
+    {
+        return TileAt(x, y).IsInRun();
+    }
+
+    bool IsDescended(size_t x, size_t y) const
+    {
+        return TileAt(x, y).IsDescended();
+    }
+
+    int LowerHeight(size_t x, size_t y);
+    void MoveDown(size_t x, size_t y);
+
+#if defined(PIT_CHECK_INCREMENTAL)
+    void CheckAgainst(const BasicPit& full) const;
+#endif
+
+    void ApplyGravity();
+    void ApplyGravity(size_t x, bool& landed);
+    void ApplySlabGravity(bool& landed);
+    void MoveSlabDown(Slab& slab);
+    void LowerSlab(Slab& slab, bool& landed);
+    void RemoveSlab(size_t i);
+    void IndexSlabs(size_t first, size_t last);
+    void RemoveSlabs(size_t x, size_t y, size_t width, size_t height);
+    void BreakSlabs(const Bitboard& cleared);
+    void BreakSlab(const Slab& slab);
+    TileType BrokenTile(size_t x, size_t y, TileType left, TileType above) const;
+    void DropGarbage();
+    void CheckForRuns();
+    void RemoveRuns();
+    void RemoveDeadChains();
+
+    void Publish(Event::Type type, size_t x = 0, size_t y = 0, size_t chain = 0, size_t size = 0, size_t run = 0)
+    {
+        if (events_.queue != nullptr)
+        {
+            events_.queue->Push(Event{tick_, type, static_cast<uint8_t>(x), static_cast<uint8_t>(y),
+                                      static_cast<uint8_t>(chain), static_cast<uint16_t>(size), static_cast<uint8_t>(run)});
+        }
+    }
+
+    size_t ColoursInPlay() const
+    {
+        return std::min(Difficulty::ColoursForLevel(level_), numColours);
+    }
+
+    // Where the pit's events go. It isn't copied along with the pit, so that a copy, e.g., in a search, can't publish
+    // into a queue that something else is draining.
+    struct EventSink
+    {
+        EventSink() = default;
+        EventSink(const EventSink&) {}
+        EventSink& operator=(const EventSink&)
+        {
+            return *this;
+        }
+
+        EventQueue* queue{nullptr};
+    };
+
+    void Refill(size_t row);
+    void RefillBottomRow();
+    void RefillRows(int numRows);
+
+    void FindRunLinks(Bitboard& down, Bitboard& right) const;
+    void LabelRuns(const Bitboard& down, const Bitboard& right, const Bitboard& verticalSeeds, const Bitboard& horizontalSeeds);
+
+    std::array<Tile, cols * rows> tiles_;
+    std::array<Bitboard, numTileTypes> typeMasks_{};// One mask per tile type. TileType::None is the empty mask.
+    Bitboard descendedMask_{};
+    Bitboard chainMask_{};// Tiles with a non-zero chain.
+    Bitboard slabMask_{};// Walls that are part of a slab of garbage.
+    Bitboard dirtyMask_{};// Tiles whose type or descended state changed since runs were last checked.
+    uint64_t hash_{0};
+    bool fullUpdate_{false};// Update every tile instead of only those that are affected. Used to check Update().
+    size_t firstRow_{0};
+    size_t level_{1};
+    uint64_t seed_;
+    UpcomingRows upcoming_;
+    bool impacted_;
+    size_t run_;
+    size_t numRuns_{0};
+    std::array<RunRecord, maxRuns> runs_{};
+    std::array<PitCoord, cols * rows> runCoords_{};// The coordinates of every run, one run after another.
+    bool landed_{false};
+    uint32_t tick_{0};
+    bool garbage_{false};
+    size_t numSlabs_{0};
+    std::array<Slab, maxSlabs> slabs_{};// Lowest first, by bottom row, so that a stack of slabs falls together.
+    EventSink events_;
+};
+
+// The standard pit. Note that it has one more row than is visible because of the wraparound.
+using Pit = BasicPit<6, 13, 6>;
+
+extern template class BasicPit<6, 13, 6>;
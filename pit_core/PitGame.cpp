@@ -0,0 +1,92 @@
+#include "PitGame.h"
+
+#include "Difficulty.h"
+#include "Scoring.h"
+
+#include <algorithm>
+
+PitGame::PitGame(size_t level, uint64_t seed)
+{
+    Reset(level, seed);
+}
+
+void PitGame::Reset(size_t level, uint64_t seed)
+{
+    pit_.Reset(level, seed);
+    SetLevel(level);
+    cursorX_ = (Pit::cols / 2) - 1;
+    cursorY_ = Pit::rows / 2;
+    scroll_ = 0;
+    score_ = 0;
+    ticks_ = 0;
+}
+
+void PitGame::SetLevel(size_t level)
+{
+    level_ = level;
+    pit_.SetLevel(level);
+    scrollRate_ = Difficulty::ScrollRateForLevel(level);
+}
+
+void PitGame::Update(uint8_t actions)
+{
+    // This follows Playing::UpdatePlaying(), so the two must be kept in step.
+    scroll_ += (actions & Raise) ? Difficulty::subPixelsPerPixel : scrollRate_;
+    if (scroll_ >= tileSize * Difficulty::subPixelsPerPixel)
+    {
+        pit_.ScrollOne();
+        if (cursorY_ > 1)
+        {
+            cursorY_--;
+        }
+        scroll_ = 0;
+    }
+
+    if ((actions & Left) && cursorX_ > 0)
+    {
+        --cursorX_;
+    }
+    if ((actions & Right) && cursorX_ < Pit::cols - 2)
+    {
+        ++cursorX_;
+    }
+    if ((actions & Up) && cursorY_ > 1)
+    {
+        --cursorY_;
+    }
+    if ((actions & Down) && cursorY_ < Pit::rows - 2)
+    {
+        ++cursorY_;
+    }
+    if (actions & Swap)
+    {
+        pit_.Swap(cursorX_, cursorY_);
+    }
+
+    pit_.Update();
+    score_ += Scoring::ScoreRuns(pit_.Runs());
+    ++ticks_;
+}
+
+PitGame::Snapshot PitGame::Save() const
+{
+    return Snapshot{pit_.Save(), level_, cursorX_, cursorY_, scroll_, scrollRate_, score_, ticks_};
+}
+
+void PitGame::Restore(const Snapshot& snapshot)
+{
+    pit_.Restore(snapshot.pit);
+    level_ = snapshot.level;
+    cursorX_ = snapshot.cursorX;
+    cursorY_ = snapshot.cursorY;
+    scroll_ = snapshot.scroll;
+    scrollRate_ = snapshot.scrollRate;
+    score_ = snapshot.score;
+    ticks_ = snapshot.ticks;
+}
+
+void PitGame::PlaceCursor(size_t x, size_t y)
+{
+    cursorX_ = std::min<size_t>(x, Pit::cols - 2);
+    cursorY_ = std::clamp<size_t>(y, 1, Pit::rows - 2);
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Pit.h"
+#include "Zobrist.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// A game in a pit, played by the same rules as the game itself but without any graphics, sound or input: the cursor,
+// the scroll and the score. Whatever is playing passes in its actions on each update, so it can be a person, a script
+// or a search.
+class PitGame
+{
+public:
+    // What the player does on an update. Actions can be combined.
+    enum Action : uint8_t
+    {
+        None = 0,
+        Left = 1 << 0,
+        Right = 1 << 1,
+        Up = 1 << 2,
+        Down = 1 << 3,
+        Swap = 1 << 4, // Swaps the tiles under the cursor.
+        Raise = 1 << 5 // Scrolls the pit quickly for as long as it's held.
+    };
+
+    // Everything about a game that decides how it plays from here on.
+    struct Snapshot
+    {
+        Pit::Snapshot pit;
+        size_t level;
+        size_t cursorX;
+        size_t cursorY;
+        uint32_t scroll;
+        uint32_t scrollRate;
+        uint64_t score;
+        uint32_t ticks;
+    };
+
+    explicit PitGame(size_t level = 1, uint64_t seed = 0);
+
+    void Reset(size_t level, uint64_t seed);
+    void SetLevel(size_t level);
+    void Update(uint8_t actions);
+
+    Snapshot Save() const;
+    void Restore(const Snapshot& snapshot);
+
+    // Moves the cursor straight to the given position, for anything that plans swaps rather than button presses.
+    void PlaceCursor(size_t x, size_t y);
+
+    const Pit& GetPit() const
+    {
+        return pit_;
+    }
+
+    Pit& GetPit()
+    {
+        return pit_;
+    }
+
+    size_t CursorX() const
+    {
+        return cursorX_;
+    }
+
+    size_t CursorY() const
+    {
+        return cursorY_;
+    }
+
+    size_t Level() const
+    {
+        return level_;
+    }
+
+    uint64_t Score() const
+    {
+        return score_;
+    }
+
+    // The number of updates since the game started.
+    uint32_t Ticks() const
+    {
+        return ticks_;
+    }
+
+    // How far the pit has scrolled towards the next row, in sub-pixels.
+    uint32_t Scroll() const
+    {
+        return scroll_;
+    }
+
+    // A hash of the pit and how far it has scrolled towards the next row, which between them decide how the game plays
+    // from here on. Positions that differ only in the cursor, the score or the time taken to reach them hash the same.
+    uint64_t Hash() const
+    {
+        return pit_.Hash() ^ Zobrist::ScrollKey(scroll_);
+    }
+
+    bool IsOver() const
+    {
+        return pit_.IsImpacted();
+    }
+
+    // The tiles are this many pixels high, as they are in the game.
+    static constexpr uint32_t tileSize = 16;
+
+private:
+    Pit pit_;
+    size_t level_{1};
+    size_t cursorX_{(Pit::cols / 2) - 1};
+    size_t cursorY_{Pit::rows / 2};
+    uint32_t scroll_{0};
+    uint32_t scrollRate_{0};
+    uint64_t score_{0};
+    uint32_t ticks_{0};
+};
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// The types that describe the contents of a pit, whatever its size.
+struct PitTypes
+{
+    enum class TileType : uint8_t
+    {
+        None,
+        Red,
+        Green,
+        Yellow,
+        Cyan,
+        Magenta,
+        Blue,
+        Wall
+    };
+
+    struct PitCoord
+    {
+        uint16_t x;
+        uint16_t y;
+    };
+
+    // A run that was removed by the last update. Its coordinates belong to the pit, so it's only valid until the pit
+    // next changes.
+    struct RunInfo
+    {
+        size_t runSize{0};
+        size_t chainLength{0};
+        const PitCoord* coord{nullptr};
+    };
+
+    // How a pit stores a run. The coordinates of every run are kept one after another in a single array, which the
+    // pit can size for the worst case up front, because no tile can be in more than one run.
+    struct RunRecord
+    {
+        uint32_t first{0};
+        uint32_t runSize{0};
+        size_t chainLength{0};
+    };
+
+    // A non-owning view of the runs that were removed by the last update. Like RunInfo, it's only valid until the pit
+    // next changes.
+    class RunView
+    {
+    public:
+        class Iterator
+        {
+        public:
+            Iterator(const RunRecord* run, const PitCoord* coords)
+                : run_{run}, coords_{coords}
+            {
+            }
+
+            RunInfo operator*() const
+            {
+                return RunInfo{run_->runSize, run_->chainLength, coords_ + run_->first};
+            }
+
+            Iterator& operator++()
+            {
+                ++run_;
+                return *this;
+            }
+
+            bool operator==(const Iterator& other) const
+            {
+                return run_ == other.run_;
+            }
+
+            bool operator!=(const Iterator& other) const
+            {
+                return run_ != other.run_;
+            }
+
+        private:
+            const RunRecord* run_;
+            const PitCoord* coords_;
+        };
+
+        RunView() = default;
+
+        RunView(const RunRecord* runs, size_t size, const PitCoord* coords)
+            : runs_{runs}, size_{size}, coords_{coords}
+        {
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        bool empty() const
+        {
+            return size_ == 0;
+        }
+
+        RunInfo operator[](size_t i) const
+        {
+            return *Iterator(runs_ + i, coords_);
+        }
+
+        Iterator begin() const
+        {
+            return Iterator(runs_, coords_);
+        }
+
+        Iterator end() const
+        {
+            return Iterator(runs_ + size_, coords_);
+        }
+
+    private:
+        const RunRecord* runs_{nullptr};
+        size_t size_{0};
+        const PitCoord* coords_{nullptr};
+    };
+
+    // A slab of garbage. Its walls are ordinary walls, and the slab is the rectangle that says where its edges are, so
+    // that it falls and lands as one. The slab has the height that counts down as it falls into the row it's in, as a
+    // tile does, so its walls' own heights stay at 0.
+    struct Slab
+    {
+        uint8_t x;
+        uint8_t y;// The top row.
+        uint8_t width;
+        uint8_t height;
+        uint8_t fallHeight;
+
+        size_t Right() const
+        {
+            return size_t{x} + width;// One past the right edge.
+        }
+
+        size_t Bottom() const
+        {
+            return size_t{y} + height - 1;
+        }
+
+        bool Covers(size_t col, size_t row) const
+        {
+            return col >= x && col < Right() && row >= y && row <= Bottom();
+        }
+    };
+
+    // A tile packs into 4 bytes so that the whole pit stays small enough to copy cheaply.
+    struct Tile
+    {
+        TileType tileType{TileType::None};
+        uint8_t runId{0};// A wall is never in a run, so one that's part of a slab of garbage keeps its slab's index here.
+        uint8_t height{0};
+        uint8_t chain{0};
+
+        Tile()
+            : Tile{TileType::None}
+        {
+        }
+
+        Tile(TileType tileType)
+            : tileType{tileType}
+        {
+        }
+
+        bool IsEmpty() const
+        {
+            return tileType == TileType::None;
+        }
+
+        bool IsMovableType() const
+        {
+            return tileType != TileType::Wall;
+        }
+
+        bool IsFixedType() const
+        {
+            return tileType == TileType::Wall;
+        }
+
+        bool IsInRun() const
+        {
+            return runId != 0 && tileType != TileType::Wall;
+        }
+
+        bool IsDescended() const
+        {
+            return height == 0;
+        }
+    };
+    static_assert(sizeof(Tile) <= 4, "A Tile should pack into 4 bytes");
+
+    // Something that happened in a pit, for anything that wants to react to it without looking at the whole pit.
+    struct Event
+    {
+        enum class Type : uint8_t
+        {
+            Swap,         // The tiles at (x, y) and (x + 1, y) were swapped.
+            Land,         // At least one falling tile landed.
+            RunFormed,    // Runs()[run] was found. It has size tiles and a chain of chain, and (x, y) is one of its tiles.
+            RunCleared,   // The tiles of Runs()[run] were removed.
+            ChainExtended,// The tile at (x, y) was given a chain of chain by a run that was removed from under it.
+            Impact,       // A tile reached the top row.
+            RowScrolled,  // The pit scrolled up by a row.
+            SlabBroken    // The slab of garbage whose top left tile is at (x, y) broke into size tiles.
+        };
+
+        uint32_t tick{0};// The update that the event happened in. Events between updates belong to the next update.
+        Type type{Type::Swap};
+        uint8_t x{0};
+        uint8_t y{0};
+        uint8_t chain{0};
+        uint16_t size{0};
+        uint8_t run{0};
+    };
+    static_assert(sizeof(Event) <= 12, "An Event should pack into 12 bytes");
+
+    // The colours in the order that levels introduce them.
+    static constexpr std::array<TileType, 6> tileColours = {
+            TileType::Red,
+            TileType::Yellow,
+            TileType::Cyan,
+            TileType::Magenta,
+            TileType::Green,
+            TileType::Blue};
+};
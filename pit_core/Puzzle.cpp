@@ -0,0 +1,274 @@
+#include "Puzzle.h"
+
+#include "Zobrist.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    // Empty squares have the same height as falling tiles, as they have in a pit that has been running for a while.
+    const uint8_t fallingHeight = 15;
+
+    // Enough updates for anything to settle, even a chain that drops every tile from the top of the pit.
+    const size_t maxSettleUpdates = 4096;
+
+    const std::string tileChars = ".RGYCMB#";
+
+    char CharFor(Pit::TileType tileType)
+    {
+        return tileChars[static_cast<size_t>(tileType)];
+    }
+
+    Pit::TileType TileTypeFor(char c)
+    {
+        const size_t i = tileChars.find(c);
+        if (i == std::string::npos)
+        {
+            throw std::runtime_error(std::string("Unknown tile '") + c + "'");
+        }
+        return static_cast<Pit::TileType>(i);
+    }
+
+    void CheckRows(const std::vector<std::string>& rows)
+    {
+        if (rows.size() != Pit::rows)
+        {
+            throw std::runtime_error("A puzzle should have " + std::to_string(Pit::rows) + " rows");
+        }
+        for (const auto& row : rows)
+        {
+            if (row.size() != Pit::cols)
+            {
+                throw std::runtime_error("A puzzle should have " + std::to_string(Pit::cols) + " columns");
+            }
+        }
+    }
+} // namespace
+
+void Puzzle::SetUp(Pit& pit) const
+{
+    pit.Reset(level, 0);
+    for (size_t y = 0; y < Pit::rows; y++)
+    {
+        for (size_t x = 0; x < Pit::cols; x++)
+        {
+            const Pit::TileType tileType = TileTypeAt(x, y);
+            pit.SetTile(x, y, tileType, tileType == Pit::TileType::None ? fallingHeight : 0);
+        }
+    }
+}
+
+bool Puzzle::IsCleared(const Pit& pit)
+{
+    for (size_t y = 0; y < Pit::rows - 1; y++)
+    {
+        for (size_t x = 0; x < Pit::cols; x++)
+        {
+            if (pit.TileTypeAt(x, y) != Pit::TileType::None)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void Puzzle::Play(Pit& pit, Swap swap)
+{
+    // Even a swap that leaves nothing to fall has to be looked at for runs, so there's always at least one update.
+    pit.Swap(swap.x, swap.y);
+    for (size_t i = 0; i < maxSettleUpdates; i++)
+    {
+        pit.Update();
+        if (pit.IsSettled())
+        {
+            return;
+        }
+    }
+}
+
+void Puzzle::SavePack(std::ostream& os, const std::vector<Puzzle>& puzzles)
+{
+    for (const auto& puzzle : puzzles)
+    {
+        os << "puzzle\n";
+        os << "level " << puzzle.level << '\n';
+        for (const auto& swap : puzzle.solution)
+        {
+            os << "swap " << int{swap.x} << ' ' << int{swap.y} << '\n';
+        }
+        for (size_t y = 0; y < Pit::rows; y++)
+        {
+            for (size_t x = 0; x < Pit::cols; x++)
+            {
+                os << CharFor(puzzle.TileTypeAt(x, y));
+            }
+            os << '\n';
+        }
+    }
+}
+
+std::vector<Puzzle> Puzzle::LoadPack(std::istream& is)
+{
+    std::vector<Puzzle> puzzles;
+    std::vector<std::string> rows;
+    const auto finish = [&puzzles, &rows] {
+        if (puzzles.empty())
+        {
+            return;
+        }
+        CheckRows(rows);
+        Puzzle& puzzle = puzzles.back();
+        for (size_t y = 0; y < Pit::rows; y++)
+        {
+            for (size_t x = 0; x < Pit::cols; x++)
+            {
+                puzzle.tiles[x + y * Pit::cols] = TileTypeFor(rows[y][x]);
+            }
+        }
+        rows.clear();
+    };
+
+    std::string line;
+    while (std::getline(is, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream words(line);
+        std::string keyword;
+        words >> keyword;
+        if (keyword == "puzzle")
+        {
+            finish();
+            puzzles.emplace_back();
+        }
+        else if (puzzles.empty())
+        {
+            throw std::runtime_error("Expected \"puzzle\" but found: " + line);
+        }
+        else if (keyword == "level")
+        {
+            words >> puzzles.back().level;
+        }
+        else if (keyword == "swap")
+        {
+            size_t x = 0;
+            size_t y = 0;
+            words >> x >> y;
+            if (x + 1 >= Pit::cols || y < 1 || y + 1 >= Pit::rows)
+            {
+                throw std::runtime_error("Swap is outside the pit: " + line);
+            }
+            puzzles.back().solution.push_back(Swap{static_cast<uint8_t>(x), static_cast<uint8_t>(y)});
+        }
+        else
+        {
+            rows.push_back(line);
+        }
+        if (words.fail())
+        {
+            throw std::runtime_error("Bad line in puzzle pack: " + line);
+        }
+    }
+    finish();
+    return puzzles;
+}
+
+PuzzleSolver::PuzzleSolver(size_t log2TableSlots)
+    : table_{log2TableSlots}
+{
+}
+
+PuzzleSolver::Result PuzzleSolver::Solve(const Puzzle& puzzle, size_t maxSwaps)
+{
+    table_.Clear();
+    result_ = Result{};
+    path_.clear();
+    if (pits_.size() < maxSwaps + 1)
+    {
+        pits_.resize(maxSwaps + 1);
+    }
+    puzzle.SetUp(pits_[0]);
+    result_.solutions = Search(0, maxSwaps);
+    return result_;
+}
+
+bool PuzzleSolver::CanClear(const Pit& pit)
+{
+    std::array<size_t, static_cast<size_t>(Pit::TileType::Wall) + 1> counts{};
+    for (size_t y = 0; y < Pit::rows - 1; y++)
+    {
+        for (size_t x = 0; x < Pit::cols; x++)
+        {
+            ++counts[static_cast<size_t>(pit.TileTypeAt(x, y))];
+        }
+    }
+    for (const auto tileType : Pit::tileColours)
+    {
+        const size_t count = counts[static_cast<size_t>(tileType)];
+        if (count > 0 && count < 3)
+        {
+            return false;
+        }
+    }
+    return counts[static_cast<size_t>(Pit::TileType::Wall)] == 0;
+}
+
+size_t PuzzleSolver::Search(size_t depth, size_t remaining)
+{
+    const Pit& pit = pits_[depth];
+    ++result_.positions;
+    if (Puzzle::IsCleared(pit))
+    {
+        if (result_.solution.empty())
+        {
+            result_.solution = path_;
+        }
+        return 1;
+    }
+    if (remaining == 0 || !CanClear(pit))
+    {
+        return 0;
+    }
+
+    // The same position with the same number of swaps to spare always has the same number of solutions.
+    const uint64_t key = pit.Hash() ^ Zobrist::Mix(remaining);
+    uint32_t known = 0;
+    if (table_.Probe(key, known))
+    {
+        return known;
+    }
+
+    size_t found = 0;
+    for (size_t y = 1; y < Pit::rows - 1 && found < enough; y++)
+    {
+        for (size_t x = 0; x + 1 < Pit::cols && found < enough; x++)
+        {
+            // Swapping two tiles of the same type changes nothing, and walls can't be swapped at all.
+            const Pit::TileType left = pit.TileTypeAt(x, y);
+            const Pit::TileType right = pit.TileTypeAt(x + 1, y);
+            if (left == right || left == Pit::TileType::Wall || right == Pit::TileType::Wall)
+            {
+                continue;
+            }
+            const Puzzle::Swap swap{static_cast<uint8_t>(x), static_cast<uint8_t>(y)};
+            pits_[depth + 1] = pit;
+            Puzzle::Play(pits_[depth + 1], swap);
+            path_.push_back(swap);
+            found += Search(depth + 1, remaining - 1);
+            path_.pop_back();
+        }
+    }
+    found = std::min(found, enough);
+    table_.Store(key, static_cast<uint32_t>(found));
+    return found;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Pit.h"
+#include "TranspositionTable.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+// A board that has to be cleared in a given number of swaps, with nothing scrolling in to help.
+//
+// The bottom row of the pit is the floor. It never takes part in runs, so only the rows above it have to be cleared.
+struct Puzzle
+{
+    struct Swap
+    {
+        uint8_t x;
+        uint8_t y;
+    };
+
+    size_t level{1};
+    std::array<Pit::TileType, Pit::cols * Pit::rows> tiles{};// One row after another, from the top.
+    std::vector<Swap> solution;
+
+    // The number of swaps that the puzzle has to be cleared in.
+    size_t Swaps() const
+    {
+        return solution.size();
+    }
+
+    Pit::TileType TileTypeAt(size_t x, size_t y) const
+    {
+        return tiles[x + y * Pit::cols];
+    }
+
+    // Resets the pit to the puzzle's board.
+    void SetUp(Pit& pit) const;
+
+    // Whether every row above the floor is empty.
+    static bool IsCleared(const Pit& pit);
+
+    // Swaps the tiles at the given position, then updates the pit until it has settled again.
+    static void Play(Pit& pit, Swap swap);
+
+    // Writes puzzles in the same text format as the benchmark's boards, with a "puzzle" line before each one and a
+    // "swap x y" line for each swap in its solution.
+    static void SavePack(std::ostream& os, const std::vector<Puzzle>& puzzles);
+
+    // Throws std::runtime_error if the stream doesn't hold a pack of puzzles.
+    static std::vector<Puzzle> LoadPack(std::istream& is);
+};
+
+// Finds every way of clearing a puzzle's board in up to a given number of swaps, by trying every swap at every step.
+//
+// Positions that have already been searched with as many swaps to spare are looked up rather than searched again, and
+// positions with a colour that has fewer tiles than it takes to make a run are given up on straight away. A solver is
+// only meant to be used by one thread at a time, so a generator that runs on several threads needs one for each.
+class PuzzleSolver
+{
+public:
+    struct Result
+    {
+        size_t solutions{0};                // The number of ways of clearing the board, counting no further than 2.
+        std::vector<Puzzle::Swap> solution; // The first way that was found, if there is one.
+        size_t positions{0};                // The number of positions that were looked at.
+    };
+
+    explicit PuzzleSolver(size_t log2TableSlots = 16);
+
+    Result Solve(const Puzzle& puzzle, size_t maxSwaps);
+
+private:
+    // Enough solutions to tell that a puzzle doesn't have a unique one.
+    static constexpr size_t enough = 2;
+
+    static bool CanClear(const Pit& pit);
+    size_t Search(size_t depth, size_t remaining);
+
+    TranspositionTable table_;
+    std::vector<Pit> pits_;// The position at each depth of the search.
+    std::vector<Puzzle::Swap> path_;
+    Result result_;
+};
@@ -0,0 +1,124 @@
+#include "Recording.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    const char magic[4] = {'0', 'x', '3', '0'};
+    const uint8_t recordingVersion = 2;
+
+    void WriteVarint(std::ostream& os, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            os.put(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        os.put(static_cast<char>(value));
+    }
+
+    uint64_t ReadVarint(std::istream& is)
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            const int c = is.get();
+            if (c == std::char_traits<char>::eof())
+            {
+                throw std::runtime_error("Recording is truncated");
+            }
+            value |= static_cast<uint64_t>(c & 0x7f) << shift;
+            if ((c & 0x80) == 0)
+            {
+                return value;
+            }
+        }
+        throw std::runtime_error("Recording has a bad number");
+    }
+} // namespace
+
+void Recording::Append(uint16_t buttons)
+{
+    if (holds.empty() || holds.back().buttons != buttons || holds.back().ticks == UINT32_MAX)
+    {
+        holds.push_back(Hold{buttons, 0});
+    }
+    ++holds.back().ticks;
+}
+
+size_t Recording::Ticks() const
+{
+    size_t ticks = 0;
+    for (const auto& hold : holds)
+    {
+        ticks += hold.ticks;
+    }
+    return ticks;
+}
+
+void Recording::Save(std::ostream& os) const
+{
+    os.write(magic, sizeof(magic));
+    os.put(static_cast<char>(recordingVersion));
+    WriteVarint(os, seed);
+    WriteVarint(os, level);
+    WriteVarint(os, mode);
+    WriteVarint(os, startButtons);
+    WriteVarint(os, holds.size());
+    for (const auto& hold : holds)
+    {
+        WriteVarint(os, hold.buttons);
+        WriteVarint(os, hold.ticks);
+    }
+}
+
+Recording Recording::Load(std::istream& is)
+{
+    char header[sizeof(magic)] = {};
+    is.read(header, sizeof(header));
+    if (!is || std::memcmp(header, magic, sizeof(magic)) != 0)
+    {
+        throw std::runtime_error("Not a recording");
+    }
+    if (is.get() != recordingVersion)
+    {
+        throw std::runtime_error("Unsupported recording version");
+    }
+
+    Recording recording;
+    recording.seed = ReadVarint(is);
+    recording.level = static_cast<uint32_t>(ReadVarint(is));
+    recording.mode = static_cast<uint8_t>(ReadVarint(is));
+    recording.startButtons = static_cast<uint16_t>(ReadVarint(is));
+    const uint64_t numHolds = ReadVarint(is);
+    for (uint64_t i = 0; i < numHolds; i++)
+    {
+        Hold hold;
+        hold.buttons = static_cast<uint16_t>(ReadVarint(is));
+        hold.ticks = static_cast<uint32_t>(ReadVarint(is));
+        if (hold.ticks == 0)
+        {
+            throw std::runtime_error("Recording has an empty hold");
+        }
+        recording.holds.push_back(hold);
+    }
+    return recording;
+}
+
+RecordingPlayer::RecordingPlayer(const Recording& recording)
+    : recording_{recording}
+{
+}
+
+uint16_t RecordingPlayer::Next()
+{
+    const auto& hold = recording_.holds[hold_];
+    const uint16_t buttons = hold.buttons;
+    if (++tick_ == hold.ticks)
+    {
+        ++hold_;
+        tick_ = 0;
+    }
+    return buttons;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+// Everything needed to play a game again exactly as it was played: how it started, and which buttons were held on
+// each update after that.
+//
+// Buttons tend to stay held or released for many updates at a time, so they are stored as a list of holds, each of
+// which is a set of buttons and the number of updates that it lasted. On disk, every number is a variable length
+// integer, so a few minutes of play takes a few KB.
+struct Recording
+{
+    struct Hold
+    {
+        uint16_t buttons{0};
+        uint32_t ticks{0};
+    };
+
+    uint64_t seed{0};
+    uint32_t level{1};
+    uint8_t mode{0};
+    uint16_t startButtons{0};// The buttons that were held when the game started.
+    std::vector<Hold> holds;
+
+    // Adds the buttons that were held for the next update.
+    void Append(uint16_t buttons);
+
+    // The number of updates in the recording.
+    size_t Ticks() const;
+
+    void Save(std::ostream& os) const;
+
+    // Throws std::runtime_error if the stream doesn't hold a recording.
+    static Recording Load(std::istream& is);
+};
+
+// Reads the buttons back from a recording, one update at a time.
+class RecordingPlayer
+{
+public:
+    explicit RecordingPlayer(const Recording& recording);
+
+    bool AtEnd() const
+    {
+        return hold_ == recording_.holds.size();
+    }
+
+    // Returns the buttons that were held for the next update. Must not be called at the end.
+    uint16_t Next();
+
+private:
+    const Recording& recording_;
+    size_t hold_{0};
+    uint32_t tick_{0};// The number of updates that have been read from the current hold.
+};
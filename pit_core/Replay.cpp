@@ -0,0 +1,139 @@
+#include "Replay.h"
+
+#include "Difficulty.h"
+#include "PitGame.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    // The buttons' bits in a recording, as ButtonId numbers them in the game.
+    const uint32_t backBit = 1u << 1u;
+    const uint32_t leftBit = 1u << 3u;
+    const uint32_t rightBit = 1u << 4u;
+    const uint32_t upBit = 1u << 5u;
+    const uint32_t downBit = 1u << 6u;
+    const uint32_t aBit = 1u << 7u;
+    const uint32_t bBit = 1u << 8u;
+    const uint32_t xBit = 1u << 9u;
+
+    enum class State
+    {
+        Playing,
+        Paused,
+        Over
+    };
+} // namespace
+
+Replay::Result Replay::Run(const Recording& recording, size_t maxTicks)
+{
+    const auto mode = static_cast<Mode>(recording.mode);
+    if (mode != Mode::Timed && mode != Mode::Endless)
+    {
+        throw std::runtime_error("Only timed and endless games can be played back");
+    }
+    if (recording.level < 1 || recording.level > Difficulty::maxLevel)
+    {
+        throw std::runtime_error("The recording's level is out of range");
+    }
+    if (recording.Ticks() > maxTicks)
+    {
+        throw std::runtime_error("The recording is too long");
+    }
+
+    // This follows Playing::Start().
+    Result result;
+    size_t actualLevel = recording.level;
+    if (mode == Mode::Timed)
+    {
+        result.level = std::min<size_t>(recording.level, Difficulty::maxLevel);
+        actualLevel = result.level;
+    }
+    else
+    {
+        result.level = recording.level;
+        actualLevel = Difficulty::EndlessStartingLevel(recording.level);
+    }
+    PitGame game{actualLevel, recording.seed};
+    game.GetPit().SetGarbage(mode == Mode::Endless);
+    State state = State::Playing;
+    uint32_t remainingTicks = Difficulty::timedModeUpdates;
+    uint32_t ticksToNextLevelChange = Difficulty::endlessModeUpdates;
+    bool fastScrollAllowed = false;
+
+    // This follows Playing::Update(), with the buttons that were pressed on each update worked out as Buttons does.
+    uint32_t held = recording.startButtons;
+    RecordingPlayer player{recording};
+    while (!player.AtEnd() && state != State::Over)
+    {
+        const uint32_t next = player.Next();
+        const uint32_t pressed = (held ^ next) & next;
+        held = next;
+
+        const uint32_t delta = (state == State::Playing) ? 1 : 0;
+        result.ticks += delta;
+        if (mode == Mode::Timed)
+        {
+            if (delta > remainingTicks)
+            {
+                state = State::Over;
+                ++result.level;
+                remainingTicks = 0;
+                continue;
+            }
+            remainingTicks -= delta;
+        }
+        else if (delta > ticksToNextLevelChange)
+        {
+            result.level = std::min<size_t>(result.level + 1, Difficulty::maxLevel);
+            game.SetLevel(result.level);
+            ticksToNextLevelChange = Difficulty::endlessModeUpdates;
+        }
+        else
+        {
+            ticksToNextLevelChange -= delta;
+        }
+
+        if (state == State::Playing)
+        {
+            // This follows Playing::UpdatePlaying().
+            fastScrollAllowed = fastScrollAllowed || (pressed & xBit) != 0;
+            uint8_t actions = PitGame::None;
+            actions |= (pressed & leftBit) ? PitGame::Left : PitGame::None;
+            actions |= (pressed & rightBit) ? PitGame::Right : PitGame::None;
+            actions |= (pressed & upBit) ? PitGame::Up : PitGame::None;
+            actions |= (pressed & downBit) ? PitGame::Down : PitGame::None;
+            actions |= (pressed & aBit) ? PitGame::Swap : PitGame::None;
+            actions |= ((held & xBit) && fastScrollAllowed) ? PitGame::Raise : PitGame::None;
+            game.Update(actions);
+            if (pressed & backBit)
+            {
+                state = State::Paused;
+                fastScrollAllowed = false;
+            }
+            if (game.IsOver())
+            {
+                state = State::Over;
+                result.impacted = true;
+            }
+        }
+        else if (state == State::Paused)
+        {
+            // This follows Playing::UpdatePaused(). Quitting to the menu abandons the game, so there's nothing more to
+            // play back.
+            if (pressed & bBit)
+            {
+                break;
+            }
+            if (pressed & aBit)
+            {
+                state = State::Playing;
+                fastScrollAllowed = false;
+            }
+        }
+    }
+    result.score = game.Score();
+    result.over = state == State::Over;
+    return result;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Recording.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Plays a recording back without the game, to find out how the game that it recorded went, e.g., to check a score
+// before it goes on a leaderboard. It follows Playing::Update() with a PitGame, so the two must be kept in step.
+//
+// A recording is saved when its game ends, so playing it back stops there. Anything after that is ignored.
+struct Replay
+{
+    // The modes that a recording can be of, as they're numbered in Mode in the game.
+    enum class Mode : uint8_t
+    {
+        Timed,
+        Endless,
+        Puzzle,
+        Practice
+    };
+
+    struct Result
+    {
+        uint64_t score{0};
+        size_t level{1};     // The level that the game finished on. A timed game that lasts counts as the next level.
+        uint32_t ticks{0};   // The number of updates that were played, leaving out those that were paused.
+        bool over{false};    // Whether the game ended, rather than the recording stopping first.
+        bool impacted{false};
+    };
+
+    // Throws std::runtime_error if the recording is longer than maxTicks, or can't be played back without the game,
+    // e.g., because it's of a puzzle.
+    static Result Run(const Recording& recording, size_t maxTicks);
+};
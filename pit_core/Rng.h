@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+// A small, fast random number generator (PCG32) whose output depends only on its seed, so that a seed reproduces the
+// same game on every platform. Its whole state is a single integer, so copying a pit copies its future too.
+class Rng
+{
+public:
+    explicit Rng(uint64_t seed = 0)
+    {
+        Seed(seed);
+    }
+
+    void Seed(uint64_t seed)
+    {
+        state_ = 0;
+        Next();
+        state_ += seed;
+        Next();
+    }
+
+    uint32_t Next()
+    {
+        const uint64_t old = state_;
+        state_ = old * multiplier + increment;
+        const auto xorShifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+        const auto rotation = static_cast<uint32_t>(old >> 59u);
+        return (xorShifted >> rotation) | (xorShifted << ((0u - rotation) & 31u));
+    }
+
+    uint64_t Next64()
+    {
+        const uint64_t high = Next();
+        return (high << 32u) | Next();
+    }
+
+    // Returns an integer in the closed range [lo, hi]. This uses Lemire's multiply and reject method rather than
+    // std::uniform_int_distribution, whose output differs between standard libraries.
+    int Between(int lo, int hi)
+    {
+        const uint32_t range = static_cast<uint32_t>(hi - lo) + 1u;
+        uint64_t product = uint64_t{Next()} * range;
+        auto low = static_cast<uint32_t>(product);
+        if (low < range)
+        {
+            const uint32_t threshold = (0u - range) % range;
+            while (low < threshold)
+            {
+                product = uint64_t{Next()} * range;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return lo + static_cast<int>(product >> 32u);
+    }
+
+    // Returns an integer in [0, n) from exactly one draw. Unlike Between() it never redraws, so it is biased, but only
+    // by at most n / 2^32.
+    uint32_t Below(uint32_t n)
+    {
+        return static_cast<uint32_t>((uint64_t{Next()} * n) >> 32u);
+    }
+
+    bool operator==(const Rng& other) const
+    {
+        return state_ == other.state_;
+    }
+
+    bool operator!=(const Rng& other) const
+    {
+        return state_ != other.state_;
+    }
+
+private:
+    static constexpr uint64_t multiplier = 6364136223846793005ull;
+    static constexpr uint64_t increment = 1442695040888963407ull;
+
+    uint64_t state_{0};
+};
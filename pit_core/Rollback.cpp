@@ -0,0 +1,227 @@
+#include "Rollback.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace
+{
+    const uint8_t magic = 0x30;
+    const size_t headerSize = 27;
+
+    using Clock = std::chrono::steady_clock;
+
+    double SecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void Write32(std::vector<uint8_t>& packet, uint32_t value)
+    {
+        for (uint32_t shift = 0; shift < 32; shift += 8)
+        {
+            packet.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    void Write64(std::vector<uint8_t>& packet, uint64_t value)
+    {
+        Write32(packet, static_cast<uint32_t>(value));
+        Write32(packet, static_cast<uint32_t>(value >> 32u));
+    }
+
+    uint32_t Read32(const uint8_t* data)
+    {
+        return uint32_t{data[0]} | (uint32_t{data[1]} << 8u) | (uint32_t{data[2]} << 16u) | (uint32_t{data[3]} << 24u);
+    }
+
+    uint64_t Read64(const uint8_t* data)
+    {
+        return uint64_t{Read32(data)} | (uint64_t{Read32(data + 4)} << 32u);
+    }
+} // namespace
+
+RollbackSession::RollbackSession(const Versus& versus, const Options& options)
+    : options_{options},
+      versus_{versus},
+      firstMisprediction_{std::numeric_limits<uint32_t>::max()}
+{
+    options_.localPlayer = std::min<size_t>(options_.localPlayer, Versus::players - 1);
+    options_.inputDelay = std::min(options_.inputDelay, maxInputDelay);
+    options_.maxRollback = std::clamp<uint32_t>(options_.maxRollback, 1, maxMaxRollback);
+
+    // Neither player can act before the input delay is up, so both sides already know that nobody does.
+    localFrames_ = options_.inputDelay;
+    remoteFrames_ = options_.inputDelay;
+    peerAck_ = options_.inputDelay;
+    hashes_[0] = versus_.Hash();
+    outcomes_.fill(notOver);
+}
+
+bool RollbackSession::ShouldWait() const
+{
+    // Each side's idea of how far ahead it is includes the latency, but the latency cancels out in the difference, which
+    // is twice how far ahead this side really is. Jitter makes it wobble by a frame or so, which isn't worth a wait.
+    const int32_t advantage = static_cast<int32_t>(frame_ - peerFrame_);
+    return !finished_ && advantage - peerAdvantage_ >= 4;
+}
+
+void RollbackSession::Advance(uint8_t actions)
+{
+    const auto start = Clock::now();
+    localActions_[localFrames_ % historySize] = actions;
+    ++localFrames_;
+
+    // Go back to the first frame that was guessed wrongly, and play forward again to the present.
+    if (firstMisprediction_ < frame_)
+    {
+        const auto rollbackStart = Clock::now();
+        const uint32_t depth = frame_ - firstMisprediction_;
+        versus_.Restore(snapshots_[firstMisprediction_ % historySize]);
+        for (uint32_t frame = firstMisprediction_; frame < frame_; frame++)
+        {
+            Simulate(frame);
+        }
+        const double seconds = SecondsSince(rollbackStart);
+        ++stats_.rollbacks;
+        stats_.resimulatedFrames += depth;
+        ++stats_.depths[std::min<size_t>(depth, maxMaxRollback)];
+        stats_.resimulationSeconds += seconds;
+        stats_.maxResimulationSeconds = std::max(stats_.maxResimulationSeconds, seconds);
+    }
+    firstMisprediction_ = std::numeric_limits<uint32_t>::max();
+
+    Simulate(frame_);
+    ++frame_;
+    Confirm();
+    ++stats_.frames;
+    stats_.maxAdvanceSeconds = std::max(stats_.maxAdvanceSeconds, SecondsSince(start));
+}
+
+void RollbackSession::Simulate(uint32_t frame)
+{
+    const size_t slot = frame % historySize;
+    snapshots_[slot] = versus_.Save();
+
+    // Button presses are rare, but raising the pit is held, so the best guess for the other player is that they keep
+    // on raising it if they were.
+    uint8_t remote = PitGame::None;
+    if (frame < remoteFrames_)
+    {
+        remote = remoteActions_[slot];
+    }
+    else if (remoteFrames_ > 0)
+    {
+        remote = remoteActions_[(remoteFrames_ - 1) % historySize] & PitGame::Raise;
+    }
+    guesses_[slot] = remote;
+
+    std::array<uint8_t, Versus::players> actions{};
+    actions[options_.localPlayer] = localActions_[slot];
+    actions[1 - options_.localPlayer] = remote;
+    versus_.Update(actions);
+
+    const size_t next = (frame + 1) % historySize;
+    hashes_[next] = versus_.Hash();
+    outcomes_[next] = versus_.IsOver() ? static_cast<int8_t>(versus_.Winner()) : notOver;
+}
+
+void RollbackSession::Confirm()
+{
+    confirmedFrame_ = std::min(frame_, remoteFrames_);
+    const int8_t outcome = outcomes_[confirmedFrame_ % historySize];
+    if (outcome != notOver)
+    {
+        finished_ = true;
+        winner_ = outcome;
+    }
+
+    // Check the other side's hash once this side has confirmed the same frame, as long as it's still in the history.
+    if (peerCheckPending_ && peerCheckFrame_ <= confirmedFrame_)
+    {
+        if (peerCheckFrame_ + historySize > frame_ && hashes_[peerCheckFrame_ % historySize] != peerCheckHash_)
+        {
+            ++stats_.desyncs;
+        }
+        peerCheckPending_ = false;
+    }
+}
+
+std::vector<uint8_t> RollbackSession::WritePacket() const
+{
+    // Everything that the other side hasn't acknowledged goes in every packet.
+    const uint32_t count = localFrames_ - peerAck_;
+    const int32_t advantage = std::clamp(static_cast<int32_t>(frame_ - peerFrame_), -127, 127);
+    std::vector<uint8_t> packet;
+    packet.reserve(headerSize + count);
+    packet.push_back(magic);
+    Write32(packet, frame_);
+    packet.push_back(static_cast<uint8_t>(static_cast<int8_t>(advantage)));
+    Write32(packet, remoteFrames_);
+    Write32(packet, confirmedFrame_);
+    Write64(packet, ConfirmedHash());
+    Write32(packet, peerAck_);
+    packet.push_back(static_cast<uint8_t>(count));
+    for (uint32_t frame = peerAck_; frame < localFrames_; frame++)
+    {
+        packet.push_back(localActions_[frame % historySize]);
+    }
+    return packet;
+}
+
+void RollbackSession::ReadPacket(const uint8_t* data, size_t size)
+{
+    if (size < headerSize || data[0] != magic || size != headerSize + data[headerSize - 1])
+    {
+        ++stats_.badPackets;
+        return;
+    }
+    const uint32_t frame = Read32(data + 1);
+    const auto advantage = static_cast<int8_t>(data[5]);
+    const uint32_t ack = Read32(data + 6);
+    const uint32_t confirmedFrame = Read32(data + 10);
+    const uint64_t confirmedHash = Read64(data + 14);
+    const uint32_t firstFrame = Read32(data + 22);
+    const uint32_t count = data[26];
+    if (ack > localFrames_ || count > historySize)
+    {
+        ++stats_.badPackets;
+        return;
+    }
+    ++stats_.packetsRead;
+
+    // Packets can arrive out of order, so only newer news counts.
+    peerAck_ = std::max(peerAck_, ack);
+    if (frame >= peerFrame_)
+    {
+        peerFrame_ = frame;
+        peerAdvantage_ = advantage;
+    }
+    if (confirmedFrame > peerCheckFrame_)
+    {
+        peerCheckFrame_ = confirmedFrame;
+        peerCheckHash_ = confirmedHash;
+        peerCheckPending_ = true;
+    }
+
+    // Take the other player's actions in order, noting the first one that was guessed wrongly.
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint32_t actionFrame = firstFrame + i;
+        if (actionFrame < remoteFrames_)
+        {
+            continue;
+        }
+        if (actionFrame > remoteFrames_ || actionFrame + options_.maxRollback >= frame_ + historySize)
+        {
+            break;
+        }
+        const size_t slot = actionFrame % historySize;
+        remoteActions_[slot] = data[headerSize + i];
+        if (actionFrame < frame_ && guesses_[slot] != remoteActions_[slot])
+        {
+            firstMisprediction_ = std::min(firstMisprediction_, actionFrame);
+        }
+        ++remoteFrames_;
+    }
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Versus.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Keeps a versus game in step between two machines, in the style of GGPO. Each machine runs the whole game. It plays
+// its own player's actions as soon as they're made, and guesses that the other player hasn't pressed anything new but
+// is still holding whatever they were holding. When the other player's actual actions arrive and they differ from the
+// guess, it goes back to the frame where they differed and plays forward again to the present, all within the frame.
+// Neither machine ever waits for the network unless it gets too far ahead of what it has heard.
+//
+// The session doesn't know how packets get from one machine to the other. It writes what needs to be sent, and reads
+// what arrives, which can be late, lost, duplicated or out of order. Every packet repeats each of the local player's
+// actions until the other side has acknowledged them, so a lost packet costs nothing but time.
+class RollbackSession
+{
+public:
+    struct Options
+    {
+        size_t localPlayer{0};
+        uint32_t inputDelay{2}; // Local actions are played this many frames late, which hides that much latency.
+        uint32_t maxRollback{8};// The furthest that the session will guess ahead of the other player.
+    };
+
+    static constexpr uint32_t maxInputDelay = 8;
+    static constexpr uint32_t maxMaxRollback = 16;
+
+    // How much rolling back has been done, and what it has cost.
+    struct Stats
+    {
+        uint64_t frames{0};
+        uint64_t rollbacks{0};
+        uint64_t resimulatedFrames{0};
+        std::array<uint64_t, maxMaxRollback + 1> depths{};// The number of rollbacks by how many frames they went back.
+        double resimulationSeconds{0.0};
+        double maxResimulationSeconds{0.0};
+        double maxAdvanceSeconds{0.0};// The longest that Advance() has taken, including any rolling back.
+        uint64_t packetsRead{0};
+        uint64_t badPackets{0};
+        uint64_t desyncs{0};// Frames where the other side's game turned out differently.
+    };
+
+    RollbackSession(const Versus& versus, const Options& options);
+
+    // Whether the session can move on a frame without guessing more than maxRollback frames ahead of the other player.
+    bool CanAdvance() const
+    {
+        return !IsFinished() && frame_ < remoteFrames_ + options_.maxRollback && localFrames_ + 1 < peerAck_ + historySize;
+    }
+
+    // Whether this machine is a couple of frames ahead of the other one, and should skip a frame to let it catch up.
+    // Otherwise the one that started first would keep running into maxRollback.
+    bool ShouldWait() const;
+
+    // Moves on a frame with the local player's actions, first rolling back and playing forward again if the other
+    // player's actions turned out to differ from the guesses. Must only be called if CanAdvance().
+    void Advance(uint8_t actions);
+
+    // Writes a packet to send to the other side. It should be sent every frame, whether or not the session moved on.
+    std::vector<uint8_t> WritePacket() const;
+
+    // Reads a packet from the other side. Packets that are malformed are counted and ignored.
+    void ReadPacket(const uint8_t* data, size_t size);
+
+    // The game as it stands, with guesses for the other player's most recent actions.
+    const Versus& Game() const
+    {
+        return versus_;
+    }
+
+    // The number of frames that have been played.
+    uint32_t Frame() const
+    {
+        return frame_;
+    }
+
+    // The number of frames for which both players' actions are known, and the hash of the game after them.
+    uint32_t ConfirmedFrame() const
+    {
+        return confirmedFrame_;
+    }
+
+    uint64_t ConfirmedHash() const
+    {
+        return hashes_[confirmedFrame_ % historySize];
+    }
+
+    // Whether the game is over, counting only frames for which both players' actions are known.
+    bool IsFinished() const
+    {
+        return finished_;
+    }
+
+    int Winner() const
+    {
+        return winner_;
+    }
+
+    const Stats& GetStats() const
+    {
+        return stats_;
+    }
+
+private:
+    static constexpr uint32_t historySize = 64;
+    static constexpr int8_t notOver = -2;
+
+    void Simulate(uint32_t frame);
+    void Confirm();
+
+    Options options_;
+    Versus versus_;
+    uint32_t frame_{0};
+    uint32_t localFrames_;             // The number of frames for which the local player's actions are known.
+    uint32_t remoteFrames_;            // The number of frames for which the other player's actions are known.
+    uint32_t peerAck_;                 // The number of the local player's frames that the other side has.
+    uint32_t peerFrame_{0};            // The frame that the other side had reached when it last wrote.
+    int32_t peerAdvantage_{0};         // How far ahead of this side the other side thought it was.
+    uint32_t firstMisprediction_;      // The earliest frame whose guess turned out to be wrong, if any.
+    uint32_t confirmedFrame_{0};
+    uint32_t peerCheckFrame_{0};       // A frame that the other side has confirmed, and its hash.
+    uint64_t peerCheckHash_{0};
+    bool peerCheckPending_{false};
+    bool finished_{false};
+    int winner_{-1};
+    std::array<uint8_t, historySize> localActions_{};
+    std::array<uint8_t, historySize> remoteActions_{};
+    std::array<uint8_t, historySize> guesses_{};// The actions that were used for the other player on each frame.
+    std::array<Versus::Snapshot, historySize> snapshots_;
+    std::array<uint64_t, historySize> hashes_{}; // The hash of the game after each frame.
+    std::array<int8_t, historySize> outcomes_{};// The winner after each frame, -1 for a draw, or notOver.
+    Stats stats_;
+};
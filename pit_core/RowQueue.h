@@ -0,0 +1,151 @@
+#pragma once
+
+#include "PitTypes.h"
+#include "Rng.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// The rows that will scroll into the bottom of a pit. They are generated a batch at a time, ahead of when they are
+// needed, so that scrolling only has to copy a row, and so that anything that wants to know what's coming can look.
+//
+// No tile is the same colour as the tile to its left or the tile two rows above it. Rather than redrawing until it
+// gets a colour that is allowed, each tile draws once from the colours that are allowed, so every row costs the same.
+//
+// Width is the width of a row, or 0 if the width is chosen at runtime. Depth is the number of rows that can always be
+// seen ahead.
+template<size_t Width, size_t Depth>
+class RowQueue : public PitTypes
+{
+public:
+    static constexpr size_t depth = Depth;
+
+    static_assert(depth >= 1, "A RowQueue must hold at least the next row");
+
+    explicit RowQueue(size_t cols = Width)
+        : cols_{cols}
+    {
+        if constexpr (Width == 0)
+        {
+            rows_.resize(cols_ * capacity);
+        }
+    }
+
+    // Starts a new sequence of rows from the given seed.
+    void Reset(uint64_t seed, size_t numColours)
+    {
+        rng_.Seed(seed);
+        numColours_ = std::min(numColours, tileColours.size());
+
+        // There is nothing above the first two rows.
+        std::fill(rows_.begin(), rows_.begin() + history * cols_, TileType::None);
+        next_ = history;
+        end_ = history;
+        Generate(depth);
+    }
+
+    // Changes the number of colours. The rows that are queued are replaced so that the change is seen straight away.
+    void SetColours(size_t numColours)
+    {
+        numColours = std::min(numColours, tileColours.size());
+        if (numColours != numColours_)
+        {
+            numColours_ = numColours;
+            end_ = next_;
+            Generate(depth);
+        }
+    }
+
+    // The n'th row to come, where row 0 is the next row. n must be less than depth.
+    const TileType* Peek(size_t n = 0) const
+    {
+        return &rows_[Slot(next_ + n) * cols_];
+    }
+
+    // Removes the next row, generating another batch if that leaves too few to look ahead.
+    void Pop()
+    {
+        ++next_;
+        if (end_ - next_ < depth)
+        {
+            Generate(depth);
+        }
+    }
+
+    size_t Cols() const
+    {
+        return cols_;
+    }
+
+private:
+    // The two most recently popped rows are kept so that the rows after them can be checked against the row two above.
+    static constexpr size_t history = 2;
+    static constexpr size_t capacity = 2 * depth + history;
+
+    using Rows = std::conditional_t<Width == 0, std::vector<TileType>, std::array<TileType, Width * capacity>>;
+
+    static constexpr std::array<uint8_t, static_cast<size_t>(TileType::Wall) + 1> colourIndex_ = [] {
+        std::array<uint8_t, static_cast<size_t>(TileType::Wall) + 1> colourIndex{};
+        for (auto& index : colourIndex)
+        {
+            index = static_cast<uint8_t>(tileColours.size());
+        }
+        for (size_t i = 0; i < tileColours.size(); i++)
+        {
+            colourIndex[static_cast<size_t>(tileColours[i])] = static_cast<uint8_t>(i);
+        }
+        return colourIndex;
+    }();
+
+    static size_t Slot(size_t row)
+    {
+        return row % capacity;
+    }
+
+    void Generate(size_t numRows)
+    {
+        for (size_t n = 0; n < numRows; n++, end_++)
+        {
+            TileType* row = &rows_[Slot(end_) * cols_];
+            const TileType* above = &rows_[Slot(end_ - history) * cols_];
+            TileType left = TileType::None;
+            for (size_t x = 0; x < cols_; x++)
+            {
+                left = Draw(left, above[x]);
+                row[x] = left;
+            }
+        }
+    }
+
+    // Draws a colour that is neither of the given tile types. Colours that aren't allowed are skipped over by counting
+    // past them, so that it only takes one draw.
+    TileType Draw(TileType left, TileType above)
+    {
+        size_t lower = colourIndex_[static_cast<size_t>(left)];
+        size_t upper = colourIndex_[static_cast<size_t>(above)];
+        if (lower > upper)
+        {
+            std::swap(lower, upper);
+        }
+        if (lower == upper)
+        {
+            upper = tileColours.size();
+        }
+        const size_t allowed = numColours_ - (lower < numColours_) - (upper < numColours_);
+        size_t colour = rng_.Below(static_cast<uint32_t>(allowed));
+        colour += colour >= lower;
+        colour += colour >= upper;
+        return tileColours[colour];
+    }
+
+    size_t cols_;
+    size_t numColours_{3};
+    size_t next_{history};// The row that Peek(0) returns, counting from the start of the sequence.
+    size_t end_{history}; // One past the last row that has been generated.
+    Rng rng_;
+    Rows rows_{};
+};
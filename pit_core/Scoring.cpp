@@ -0,0 +1,40 @@
+#include "Scoring.h"
+
+uint64_t Scoring::RunScore(size_t runSize)
+{
+    switch (runSize)
+    {
+    case 3:
+        return 10;
+    case 4:
+        return 25;
+    case 5:
+        return 50;
+    case 6:
+        return 100;
+    case 7:
+        return 250;
+    case 8:
+        return 500;
+    case 9:
+        return 1000;
+    default:
+        return 0;
+    }
+}
+
+uint64_t Scoring::ScoreRun(const PitTypes::RunInfo& runInfo, size_t multiplier)
+{
+    // Longer chains and more simultaneous runs multiply the score.
+    return RunScore(runInfo.runSize) * (runInfo.chainLength + 1) * multiplier;
+}
+
+uint64_t Scoring::ScoreRuns(const PitTypes::RunView& runs)
+{
+    uint64_t score = 0;
+    for (const auto& runInfo : runs)
+    {
+        score += ScoreRun(runInfo, runs.size());
+    }
+    return score;
+}
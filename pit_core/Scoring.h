@@ -0,0 +1,18 @@
+#pragma once
+
+#include "PitTypes.h"
+
+#include <cstdint>
+
+// The rules for scoring the runs that are removed from the pit.
+struct Scoring
+{
+    // The base score for a run of the given size. Runs of more than 9 tiles don't score.
+    static uint64_t RunScore(size_t runSize);
+
+    // The score for a run, given the number of runs that were removed at the same time.
+    static uint64_t ScoreRun(const PitTypes::RunInfo& runInfo, size_t multiplier);
+
+    // The score for all of the runs that were removed in a single update.
+    static uint64_t ScoreRuns(const PitTypes::RunView& runs);
+};
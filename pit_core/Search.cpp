@@ -0,0 +1,325 @@
+#include "Search.h"
+
+#include "TranspositionTable.h"
+#include "WorkPool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <numeric>
+
+namespace
+{
+    // A move without a swap waits for this many presses, to let falling tiles land and chains play out.
+    const uint32_t passPresses = 4;
+
+    // A position in the beam, and how it was reached.
+    struct Node
+    {
+        PitGame::Snapshot state;
+        uint64_t hash;
+        int64_t value;
+        uint32_t parent;// Its index in the previous step's beam.
+        Search::Move move;
+    };
+
+    // How a position in a step was reached, kept so that the best line can be traced back at the end.
+    struct Step
+    {
+        uint32_t parent;
+        Search::Move move;
+    };
+
+    bool IsFalling(const Pit& pit, size_t x, size_t y)
+    {
+        return pit.TileTypeAt(x, y) != Pit::TileType::None && pit.HeightAt(x, y) != 0;
+    }
+
+    bool CanSwap(const Pit& pit, size_t x, size_t y)
+    {
+        const auto left = pit.TileTypeAt(x, y);
+        const auto right = pit.TileTypeAt(x + 1, y);
+        return left != right && left != Pit::TileType::Wall && right != Pit::TileType::Wall
+               && !IsFalling(pit, x, y) && !IsFalling(pit, x + 1, y);
+    }
+
+    // A press takes at least the update that it's made on, so a rate of 0 counts as 1.
+    uint32_t PressTicks(uint32_t ticksPerPress)
+    {
+        return std::max<uint32_t>(ticksPerPress, 1);
+    }
+
+    void Wait(PitGame& game, uint32_t ticks)
+    {
+        for (uint32_t i = 0; i < ticks && !game.IsOver(); i++)
+        {
+            game.Update(PitGame::None);
+        }
+    }
+
+    // Moves the cursor to (x, y) a press at a time, then swaps. The cursor is placed up front because the only thing
+    // that affects it on the way is the scroll, which carries it up along with the tiles under it. Returns false if
+    // the tiles can't be swapped by the time that the cursor gets there, e.g., because one of them has started to fall.
+    bool PlaySwap(PitGame& game, size_t x, size_t y, uint32_t ticksPerPress, Search::Move& move)
+    {
+        ticksPerPress = PressTicks(ticksPerPress);
+        const auto presses = static_cast<uint32_t>(std::abs(static_cast<int>(x) - static_cast<int>(game.CursorX()))
+                                                   + std::abs(static_cast<int>(y) - static_cast<int>(game.CursorY())));
+        game.PlaceCursor(x, y);
+        Wait(game, presses * ticksPerPress);
+        if (game.IsOver() || !CanSwap(game.GetPit(), game.CursorX(), game.CursorY()))
+        {
+            return false;
+        }
+        move = Search::Move{game.Ticks(), static_cast<uint8_t>(game.CursorX()), static_cast<uint8_t>(game.CursorY()), true};
+        game.Update(PitGame::Swap);
+        Wait(game, ticksPerPress - 1);
+        return true;
+    }
+
+    Search::Move PlayPass(PitGame& game, uint32_t ticksPerPress)
+    {
+        ticksPerPress = PressTicks(ticksPerPress);
+        Search::Move move{game.Ticks(), static_cast<uint8_t>(game.CursorX()), static_cast<uint8_t>(game.CursorY()), false};
+        Wait(game, passPresses * ticksPerPress);
+        return move;
+    }
+
+    bool IsStopped(const Search::Options& options)
+    {
+        return options.stop && options.stop->load(std::memory_order_relaxed);
+    }
+
+    // Makes a table that's big enough for the positions in the beam to rarely push each other out of it.
+    std::unique_ptr<TranspositionTable> MakeTable(const Search::Options& options)
+    {
+        size_t log2Slots = 10;
+        while (log2Slots < 20 && (size_t{1} << log2Slots) < 4 * options.beamWidth * (options.depth + 1))
+        {
+            ++log2Slots;
+        }
+        return std::make_unique<TranspositionTable>(log2Slots);
+    }
+
+    // Adds the position that a move led to to children, unless it has already been in the beam.
+    void AddChild(const PitGame& game, uint32_t index, const Search::Move& move, const Search::Options& options,
+                  const TranspositionTable& table, std::vector<Node>& children)
+    {
+        const uint64_t hash = game.Hash();
+        uint32_t depth;
+        if (!table.Probe(hash, depth))
+        {
+            children.push_back(Node{game.Save(), hash, Search::Evaluate(game, options.goal), index, move});
+        }
+    }
+
+    // Tries every move from the given position, adding the positions that they lead to to children. The table is only
+    // read, so any number of positions can be expanded at once.
+    void Expand(const Node& node, uint32_t index, const Search::Options& options, const TranspositionTable& table,
+                PitGame& game, std::vector<Node>& children)
+    {
+        children.clear();
+        if (IsStopped(options))
+        {
+            return;
+        }
+        game.Restore(node.state);
+        if (game.IsOver())
+        {
+            return;
+        }
+        const Pit& pit = game.GetPit();
+        for (size_t y = 1; y < Pit::rows - 1; y++)
+        {
+            for (size_t x = 0; x < Pit::cols - 1; x++)
+            {
+                if (!CanSwap(pit, x, y))
+                {
+                    continue;
+                }
+                Search::Move move;
+                if (PlaySwap(game, x, y, options.ticksPerPress, move))
+                {
+                    AddChild(game, index, move, options, table, children);
+                }
+                game.Restore(node.state);
+            }
+        }
+        const Search::Move move = PlayPass(game, options.ticksPerPress);
+        AddChild(game, index, move, options, table, children);
+    }
+} // namespace
+
+int64_t Search::Evaluate(const PitGame& game, Goal goal)
+{
+    if (game.IsOver())
+    {
+        // Lasting longer is still better than not.
+        return std::numeric_limits<int64_t>::min() / 2 + game.Ticks();
+    }
+
+    // Count the empty rows above the stack, and the tiles in it.
+    const Pit& pit = game.GetPit();
+    int64_t headroom = Pit::rows;
+    int64_t tiles = 0;
+    for (size_t y = 0; y < Pit::rows - 1; y++)
+    {
+        for (size_t x = 0; x < Pit::cols; x++)
+        {
+            if (pit.TileTypeAt(x, y) != Pit::TileType::None)
+            {
+                headroom = std::min<int64_t>(headroom, static_cast<int64_t>(y));
+                ++tiles;
+            }
+        }
+    }
+
+    const auto score = static_cast<int64_t>(game.Score());
+    if (goal == Goal::Survival)
+    {
+        return headroom * 4096 - tiles * 64 + score;
+    }
+
+    // Scoring comes first, but a stack that's close to the top is about to end the game.
+    const int64_t danger = headroom < 3 ? (3 - headroom) * 10000 : 0;
+    return score * 16 + headroom * 32 - danger;
+}
+
+bool Search::Play(PitGame& game, const Move& move, uint32_t ticksPerPress)
+{
+    ticksPerPress = PressTicks(ticksPerPress);
+    if (game.Ticks() > move.tick)
+    {
+        return false;
+    }
+    Wait(game, move.tick - game.Ticks());
+    if (game.IsOver())
+    {
+        return false;
+    }
+    game.PlaceCursor(move.x, move.y);
+    if (!move.swap)
+    {
+        Wait(game, passPresses * ticksPerPress);
+        return true;
+    }
+    if (!CanSwap(game.GetPit(), move.x, move.y))
+    {
+        return false;
+    }
+    game.Update(PitGame::Swap);
+    Wait(game, ticksPerPress - 1);
+    return true;
+}
+
+Search::Result Search::Run(const PitGame& game, const Options& options, WorkPool* pool)
+{
+    std::unique_ptr<TranspositionTable> ownTable;
+    TranspositionTable* table = options.table;
+    if (!table)
+    {
+        ownTable = MakeTable(options);
+        table = ownTable.get();
+    }
+    table->Clear();
+    table->Store(game.Hash(), 0);
+
+    Result result;
+    std::vector<Node> beam{Node{game.Save(), game.Hash(), Evaluate(game, options.goal), 0, Move{}}};
+    std::vector<std::vector<Step>> steps;
+    std::vector<std::vector<Node>> children;
+    std::vector<Node> next;
+    std::vector<uint32_t> order;
+    std::vector<Node> kept;
+
+    for (size_t depth = 0; depth < options.depth; depth++)
+    {
+        // Expand every position in the beam, sharing them out between the workers if there are any. Each worker plays
+        // the moves in its own game, so they share nothing but the beam and the table, which they only read.
+        children.resize(beam.size());
+        if (pool)
+        {
+            for (size_t i = 0; i < beam.size(); i++)
+            {
+                pool->Submit([&beam, &children, &options, table, i](size_t /*worker*/) {
+                    PitGame scratch;
+                    Expand(beam[i], static_cast<uint32_t>(i), options, *table, scratch, children[i]);
+                });
+            }
+            pool->Wait();
+        }
+        else
+        {
+            PitGame scratch;
+            for (size_t i = 0; i < beam.size(); i++)
+            {
+                Expand(beam[i], static_cast<uint32_t>(i), options, *table, scratch, children[i]);
+            }
+        }
+
+        // A step that was interrupted is incomplete, so it's thrown away.
+        if (IsStopped(options))
+        {
+            break;
+        }
+
+        // Keep the best of them, leaving out all but the first of any that are the same position. The candidates are
+        // always in the same order, however the work was shared out, so the result is too. Ties go to the children of
+        // the better parent, and then to the first of its children.
+        next.clear();
+        for (const auto& expanded : children)
+        {
+            next.insert(next.end(), expanded.begin(), expanded.end());
+        }
+        result.positions += next.size();
+        order.resize(next.size());
+        std::iota(order.begin(), order.end(), uint32_t{0});
+        std::sort(order.begin(), order.end(), [&next](uint32_t a, uint32_t b) {
+            return next[a].value > next[b].value || (next[a].value == next[b].value && a < b);
+        });
+        kept.clear();
+        for (const uint32_t i : order)
+        {
+            if (kept.size() == options.beamWidth)
+            {
+                break;
+            }
+            uint32_t seenAt;
+            if (!table->Probe(next[i].hash, seenAt))
+            {
+                table->Store(next[i].hash, static_cast<uint32_t>(depth + 1));
+                kept.push_back(next[i]);
+            }
+        }
+        if (kept.empty())
+        {
+            break;
+        }
+
+        std::vector<Step> step;
+        step.reserve(kept.size());
+        for (const auto& node : kept)
+        {
+            step.push_back(Step{node.parent, node.move});
+        }
+        steps.push_back(std::move(step));
+        beam.swap(kept);
+    }
+
+    // The best position is first in the final beam. Trace back the moves that led to it.
+    PitGame best;
+    best.Restore(beam.front().state);
+    result.value = beam.front().value;
+    result.score = best.Score();
+    result.ticks = best.Ticks();
+    result.isOver = best.IsOver();
+    uint32_t index = 0;
+    for (auto step = steps.rbegin(); step != steps.rend(); ++step)
+    {
+        result.line.push_back((*step)[index].move);
+        index = (*step)[index].parent;
+    }
+    std::reverse(result.line.begin(), result.line.end());
+    return result;
+}
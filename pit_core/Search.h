@@ -0,0 +1,76 @@
+#pragma once
+
+#include "PitGame.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class TranspositionTable;
+class WorkPool;
+
+// Looks for the best sequence of swaps to play from a game's current position, using a beam search: each step of the
+// search tries every swap from every position in the beam, then keeps the best positions for the next step.
+//
+// A move is a swap at a position in the pit. Playing one takes time, because the cursor has to get there a press at a
+// time, and the pit carries on scrolling and falling meanwhile, so every move is played out update by update exactly as
+// it would be in the game. The best line can be played back with real button presses.
+//
+// Different lines often lead to the same position, e.g., by making the same swaps in a different order. The search
+// keeps the positions that it has put in the beam in a transposition table, and only keeps the first that it finds of
+// any position, so the beam isn't filled with copies of the same few positions.
+class Search
+{
+public:
+    enum class Goal
+    {
+        Score,   // Score as much as possible.
+        Survival // Keep the stack as low as possible, scoring only to break ties.
+    };
+
+    struct Options
+    {
+        Goal goal{Goal::Score};
+        size_t depth{8};        // The number of moves to look ahead.
+        size_t beamWidth{64};   // The number of positions kept after each move.
+        uint32_t ticksPerPress{6};// The number of updates between button presses. 0 counts as 1.
+
+        // If this is set, e.g., by another thread, then the search stops as soon as it can and returns the best line
+        // from the last step that it finished.
+        const std::atomic<bool>* stop{nullptr};
+
+        // The table of positions that the search has seen. If this isn't set then the search makes its own. A table
+        // can be used by one search at a time, which starts by clearing it.
+        TranspositionTable* table{nullptr};
+    };
+
+    struct Move
+    {
+        uint32_t tick{0};// The game's tick count at the update that swaps.
+        uint8_t x{0};
+        uint8_t y{0};
+        bool swap{false};// A move without a swap just lets time pass.
+    };
+
+    struct Result
+    {
+        std::vector<Move> line;
+        int64_t value{0};
+        uint64_t score{0};   // The game's score at the end of the line.
+        uint32_t ticks{0};   // The game's tick count at the end of the line.
+        bool isOver{false};  // Whether the pit impacted during the line.
+        size_t positions{0}; // The number of positions that were looked at.
+    };
+
+    // Searches from the game's current position. If a pool is given then each step's positions are shared out between
+    // its workers, and the result is the same as without it.
+    static Result Run(const PitGame& game, const Options& options, WorkPool* pool = nullptr);
+
+    // How good the game's position is for the given goal. Higher is better.
+    static int64_t Evaluate(const PitGame& game, Goal goal);
+
+    // Plays a move in the game. Returns false if the move is no longer possible, e.g., because the tiles that it swaps
+    // have scrolled out of reach.
+    static bool Play(PitGame& game, const Move& move, uint32_t ticksPerPress);
+};
@@ -0,0 +1,42 @@
+#include "TranspositionTable.h"
+
+TranspositionTable::TranspositionTable(size_t log2Slots)
+    : slots_{std::make_unique<Slot[]>(size_t{1} << log2Slots)}, mask_{(size_t{1} << log2Slots) - 1}
+{
+}
+
+void TranspositionTable::Clear()
+{
+    // Slots from the last generation never match, so they read as empty. On the rare occasion that the generation wraps
+    // around, the slots really are cleared so that nothing from long ago can come back.
+    if (++generation_ == 0)
+    {
+        for (size_t i = 0; i <= mask_; i++)
+        {
+            slots_[i].check.store(0, std::memory_order_relaxed);
+            slots_[i].data.store(0, std::memory_order_relaxed);
+        }
+        generation_ = 1;
+    }
+}
+
+bool TranspositionTable::Probe(uint64_t hash, uint32_t& data) const
+{
+    const Slot& slot = slots_[hash & mask_];
+    const uint64_t word = slot.data.load(std::memory_order_relaxed);
+    const uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ word) != hash || (word >> 32u) != generation_)
+    {
+        return false;
+    }
+    data = static_cast<uint32_t>(word);
+    return true;
+}
+
+void TranspositionTable::Store(uint64_t hash, uint32_t data)
+{
+    Slot& slot = slots_[hash & mask_];
+    const uint64_t word = (uint64_t{generation_} << 32u) | data;
+    slot.data.store(word, std::memory_order_relaxed);
+    slot.check.store(hash ^ word, std::memory_order_relaxed);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// A fixed-size table of positions that have been seen, keyed by their hashes, with a little data for each. Any number
+// of threads can probe it and store into it at once without taking locks. Each slot holds one position, and a store
+// replaces whatever was there, so a position that has been stored can be forgotten later.
+//
+// A slot is two words that are read and written separately, so a probe can see half of one store and half of another.
+// The slot holds the hash XORed with the data rather than the hash itself, so a torn slot almost never matches the hash
+// that's being probed for, and reads as empty.
+class TranspositionTable
+{
+public:
+    // Makes a table with 2^log2Slots slots.
+    explicit TranspositionTable(size_t log2Slots);
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    size_t Slots() const
+    {
+        return mask_ + 1;
+    }
+
+    // Forgets every position at once. It mustn't be called while another thread is using the table.
+    void Clear();
+
+    // Finds the data for a position. Returns false if the position isn't in the table.
+    bool Probe(uint64_t hash, uint32_t& data) const;
+
+    void Store(uint64_t hash, uint32_t data);
+
+private:
+    // Each slot's data word also holds the generation that it was stored in, so that clearing the table only has to
+    // start a new generation rather than touch every slot.
+    struct alignas(16) Slot
+    {
+        std::atomic<uint64_t> check{0};// The hash XORed with the data word.
+        std::atomic<uint64_t> data{0}; // The generation in the high half, and the data in the low half.
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    uint32_t generation_{1};
+};
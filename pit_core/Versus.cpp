@@ -0,0 +1,65 @@
+#include "Versus.h"
+
+Versus::Versus(size_t level, uint64_t seed, uint32_t maxTicks) : maxTicks_{maxTicks}
+{
+    for (auto& game : games_)
+    {
+        game.Reset(level, seed);
+    }
+}
+
+void Versus::Update(const std::array<uint8_t, players>& actions)
+{
+    if (IsOver())
+    {
+        return;
+    }
+    for (size_t i = 0; i < players; i++)
+    {
+        games_[i].Update(actions[i]);
+    }
+    ++ticks_;
+}
+
+Versus::Snapshot Versus::Save() const
+{
+    return Snapshot{{games_[0].Save(), games_[1].Save()}, ticks_};
+}
+
+void Versus::Restore(const Snapshot& snapshot)
+{
+    for (size_t i = 0; i < players; i++)
+    {
+        games_[i].Restore(snapshot.games[i]);
+    }
+    ticks_ = snapshot.ticks;
+}
+
+int Versus::Winner() const
+{
+    if (!IsOver())
+    {
+        return -1;
+    }
+    const bool over0 = games_[0].IsOver();
+    const bool over1 = games_[1].IsOver();
+    if (over0 != over1)
+    {
+        return over0 ? 1 : 0;
+    }
+    const uint64_t score0 = games_[0].Score();
+    const uint64_t score1 = games_[1].Score();
+    return (score0 == score1) ? -1 : (score0 > score1 ? 0 : 1);
+}
+
+uint64_t Versus::Hash() const
+{
+    uint64_t hash = Zobrist::Mix(ticks_);
+    for (size_t i = 0; i < players; i++)
+    {
+        const PitGame& game = games_[i];
+        const uint64_t cursor = (uint64_t{i} << 16u) | (game.CursorX() << 8u) | game.CursorY();
+        hash = Zobrist::Mix(hash ^ game.Hash() ^ Zobrist::Mix(game.Score() ^ (cursor << 40u)));
+    }
+    return hash;
+}
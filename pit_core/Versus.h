@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Difficulty.h"
+#include "PitGame.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Two players' games side by side, started from the same seed so that both get the same tiles. Whoever's pit fills up
+// first loses. If both last until the time is up then the higher score wins.
+//
+// Both players' machines run the whole thing, so it must play out exactly the same way on each, given the same actions.
+class Versus
+{
+public:
+    static constexpr size_t players = 2;
+
+    // Everything about a versus game that decides how it plays from here on.
+    struct Snapshot
+    {
+        std::array<PitGame::Snapshot, players> games;
+        uint32_t ticks;
+    };
+
+    explicit Versus(size_t level = 1, uint64_t seed = 0, uint32_t maxTicks = Difficulty::timedModeUpdates);
+
+    // Updates both games, with the actions for each player. Does nothing once the game is over.
+    void Update(const std::array<uint8_t, players>& actions);
+
+    Snapshot Save() const;
+    void Restore(const Snapshot& snapshot);
+
+    const PitGame& Game(size_t player) const
+    {
+        return games_[player];
+    }
+
+    uint32_t Ticks() const
+    {
+        return ticks_;
+    }
+
+    bool IsOver() const
+    {
+        return ticks_ >= maxTicks_ || games_[0].IsOver() || games_[1].IsOver();
+    }
+
+    // The player who won, or -1 if it's a draw or the game isn't over.
+    int Winner() const;
+
+    // A hash of both games, including the cursors and the scores, for checking that two machines agree on them.
+    uint64_t Hash() const;
+
+private:
+    std::array<PitGame, players> games_;
+    uint32_t maxTicks_;
+    uint32_t ticks_{0};
+};
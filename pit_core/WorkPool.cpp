@@ -0,0 +1,124 @@
+#include "WorkPool.h"
+
+#include <algorithm>
+
+namespace
+{
+    // The pool and worker that the current thread belongs to, if any.
+    thread_local const WorkPool* currentPool = nullptr;
+    thread_local size_t currentWorker = 0;
+} // namespace
+
+WorkPool::WorkPool(size_t numWorkers)
+{
+    if (numWorkers == 0)
+    {
+        numWorkers = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < numWorkers; i++)
+    {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < numWorkers; i++)
+    {
+        threads_.emplace_back([this, i] { Run(i); });
+    }
+}
+
+WorkPool::~WorkPool()
+{
+    Wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+void WorkPool::Submit(Task task)
+{
+    const size_t worker = (currentPool == this) ? currentWorker : nextQueue_.fetch_add(1, std::memory_order_relaxed) % Workers();
+    pending_.fetch_add(1, std::memory_order_relaxed);
+
+    // Count the task before queueing it so that the count never goes below zero.
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        Queue& queue = *queues_[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+void WorkPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+}
+
+bool WorkPool::Pop(size_t worker, Task& task)
+{
+    Queue& queue = *queues_[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool WorkPool::Steal(size_t worker, Task& task)
+{
+    // Start with the next worker along so that thieves don't all pick on the same victim.
+    for (size_t i = 1; i < Workers(); i++)
+    {
+        Queue& queue = *queues_[(worker + i) % Workers()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkPool::Run(size_t worker)
+{
+    currentPool = this;
+    currentWorker = worker;
+    for (;;)
+    {
+        Task task;
+        if (Pop(worker, task) || Steal(worker, task))
+        {
+            task(worker);
+            task = nullptr;// Release whatever the task holds before saying that it's finished.
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                finished_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [this] { return stopping_ || queued_.load(std::memory_order_relaxed) > 0; });
+        if (stopping_ && queued_.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A pool of worker threads that share out independent tasks by work stealing. Each worker has its own queue, taking
+// the newest task from it and, when it runs dry, stealing the oldest task from another worker's queue. Workers only
+// touch each other's queues when they steal, so they scale with the number of cores as long as tasks aren't tiny.
+//
+// Tasks are told which worker is running them, so that they can keep per-worker state without locking.
+class WorkPool
+{
+public:
+    using Task = std::function<void(size_t worker)>;
+
+    // Starts the given number of workers, or one per core if it's zero.
+    explicit WorkPool(size_t numWorkers = 0);
+    ~WorkPool();
+
+    WorkPool(const WorkPool&) = delete;
+    WorkPool& operator=(const WorkPool&) = delete;
+
+    size_t Workers() const
+    {
+        return queues_.size();
+    }
+
+    // Adds a task. A task that's submitted by a worker goes on that worker's queue, otherwise tasks are dealt out to the
+    // workers in turn.
+    void Submit(Task task);
+
+    // Waits until every task that has been submitted has finished, including any that they submit. Tasks mustn't call
+    // this.
+    void Wait();
+
+private:
+    // Each queue is on its own cache line so that workers don't slow each other down by sharing one.
+    struct alignas(64) Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool Pop(size_t worker, Task& task);
+    bool Steal(size_t worker, Task& task);
+    void Run(size_t worker);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;     // Signalled when there is a task to run, or when the pool is stopping.
+    std::condition_variable finished_; // Signalled when the last pending task finishes.
+    std::atomic<size_t> queued_{0};    // Tasks that are waiting in a queue.
+    std::atomic<size_t> pending_{0};   // Tasks that have been submitted but haven't finished.
+    std::atomic<size_t> nextQueue_{0};
+    bool stopping_{false};
+};
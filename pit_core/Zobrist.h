@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Keys for Zobrist hashing, where a position's hash is the XOR of a key for each thing in it, so that changing one thing
+// changes the hash by XORing out its old key and XORing in its new one.
+//
+// Each key is a fixed pseudo-random function of what it stands for, so that anything with a lot of keys can work them
+// out into a table at compile time rather than shipping a table of random numbers.
+namespace Zobrist
+{
+    // SplitMix64's finaliser, which maps every input to a different, well-scrambled output.
+    constexpr uint64_t Mix(uint64_t x)
+    {
+        x = (x ^ (x >> 30u)) * 0xbf58476d1ce4e5b9u;
+        x = (x ^ (x >> 27u)) * 0x94d049bb133111ebu;
+        return x ^ (x >> 31u);
+    }
+
+    constexpr uint64_t RotateLeft(uint64_t x, size_t n)
+    {
+        n &= 63u;
+        return n == 0 ? x : (x << n) | (x >> (64u - n));
+    }
+
+    constexpr uint64_t RotateRight(uint64_t x, size_t n)
+    {
+        return RotateLeft(x, 64u - (n & 63u));
+    }
+
+    // The keys for a tile in column x of the top row. A tile's key is the XOR of the keys for its type, chain and height,
+    // so that changing one of them, e.g., lowering a falling tile, only has to swap one small key for another.
+    constexpr uint64_t TypeKey(size_t x, uint8_t tileType)
+    {
+        return Mix((uint64_t{1} << 48u) | (uint64_t{x} << 8u) | tileType);
+    }
+
+    constexpr uint64_t ChainKey(size_t x, uint8_t chain)
+    {
+        return Mix((uint64_t{2} << 48u) | (uint64_t{x} << 8u) | chain);
+    }
+
+    constexpr uint64_t HeightKey(size_t x, uint8_t height)
+    {
+        return Mix((uint64_t{3} << 48u) | (uint64_t{x} << 8u) | height);
+    }
+
+    // The keys for a slab of garbage whose top left is in column x of the top row. The walls that it covers have keys of
+    // their own, so a slab's key is the XOR of the keys for its size, which say that the walls are a slab, and for how
+    // far it has to fall.
+    constexpr uint64_t SlabKey(size_t x, size_t width, size_t height)
+    {
+        return Mix((uint64_t{5} << 48u) | (uint64_t{x} << 16u) | (uint64_t{width} << 8u) | height);
+    }
+
+    constexpr uint64_t SlabHeightKey(size_t x, uint8_t fallHeight)
+    {
+        return Mix((uint64_t{6} << 48u) | (uint64_t{x} << 8u) | fallHeight);
+    }
+
+    // The key for how far the pit has scrolled towards the next row.
+    constexpr uint64_t ScrollKey(uint32_t scroll)
+    {
+        return Mix((uint64_t{4} << 48u) | scroll);
+    }
+} // namespace Zobrist
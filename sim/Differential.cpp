@@ -0,0 +1,549 @@
+// Plays the pit and the frozen reference pit in lockstep, with the same random swaps, scrolls and walls, over as many
+// games as it takes to reach the given number of updates on every core, and checks after every update that they agree
+// on every tile's type, height and chain, on whether the pit has impacted, and on the runs that were removed. The
+// reference is the pit as the game first played it, looking at one square at a time, so it's for checking that a faster
+// pit still plays exactly the same way.
+//
+// Usage: pit_diff [--ticks N] [--game-ticks N] [--threads N] [--seed S]
+//        pit_diff --repro FILE
+//
+// On the first disagreement it stops, shrinks the game that disagreed to as few moves as still disagree, and
+// writes that to stdout as a reproducer, which --repro plays back.
+
+#include "reference/ReferencePit.h"
+
+#include "pit_core/Difficulty.h"
+#include "pit_core/Pit.h"
+#include "pit_core/Rng.h"
+#include "pit_core/WorkPool.h"
+#include "pit_core/Zobrist.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using ReferencePit = reference::Pit;
+
+    static_assert(ReferencePit::cols == Pit::cols && ReferencePit::rows == Pit::rows, "The pits must be the same size");
+
+    struct Options
+    {
+        uint64_t ticks{100'000'000};
+        uint32_t gameTicks{4000};
+        size_t threads{0};
+        uint64_t seed{0x30};
+        std::string repro;
+    };
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+            const char* value = argv[++i];
+            if (arg == "--ticks")
+            {
+                options.ticks = std::strtoull(value, nullptr, 10);
+            }
+            else if (arg == "--game-ticks")
+            {
+                options.gameTicks = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            }
+            else if (arg == "--threads")
+            {
+                options.threads = std::strtoull(value, nullptr, 10);
+            }
+            else if (arg == "--seed")
+            {
+                options.seed = std::strtoull(value, nullptr, 0);
+            }
+            else if (arg == "--repro")
+            {
+                options.repro = value;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return options.gameTicks >= 1;
+    }
+
+    // What's done to both pits before an update, in the order that the game does it, and then a wall that's dropped in
+    // to get in the way.
+    struct Move
+    {
+        bool scroll{false};
+        bool swap{false};
+        bool wall{false};
+        uint8_t x{0};
+        uint8_t y{0};
+        uint8_t wallX{0};
+        uint8_t wallY{0};
+
+        bool IsNone() const
+        {
+            return !scroll && !swap && !wall;
+        }
+    };
+
+    // A game is decided by its seed, its level and its moves.
+    struct Game
+    {
+        uint64_t seed{0};
+        size_t level{1};
+        std::vector<Move> moves;
+    };
+
+    // Swaps far more often, and scrolls far faster, than a person would, to stir the pit up as much as possible. Now and
+    // then a wall goes in, so that tiles land on walls and runs form around them.
+    Move RandomMove(Rng& rng)
+    {
+        Move move;
+        move.scroll = rng.Below(32) == 0;
+        move.swap = rng.Below(3) == 0;
+        move.x = static_cast<uint8_t>(rng.Below(Pit::cols - 1));
+        move.y = static_cast<uint8_t>(1 + rng.Below(Pit::rows - 2));
+        move.wall = rng.Below(512) == 0;
+        move.wallX = static_cast<uint8_t>(rng.Below(Pit::cols));
+        move.wallY = static_cast<uint8_t>(1 + rng.Below(Pit::rows - 2));
+        return move;
+    }
+
+    // The seed and level of the i-th game, and a generator for its moves.
+    Game StartGame(uint64_t seed, uint64_t i, Rng& moves)
+    {
+        const uint64_t gameSeed = Zobrist::Mix(seed ^ Zobrist::Mix(i));
+        moves.Seed(Zobrist::Mix(gameSeed));
+        return Game{gameSeed, 1 + gameSeed % Difficulty::maxLevel, {}};
+    }
+
+    template<typename P>
+    void Play(P& pit, const Move& move)
+    {
+        if (move.scroll)
+        {
+            pit.ScrollOne();
+        }
+        if (move.swap)
+        {
+            pit.Swap(move.x, move.y);
+        }
+        if (move.wall)
+        {
+            pit.SetTile(move.wallX, move.wallY, PitTypes::TileType::Wall);
+        }
+        pit.Update();
+    }
+
+    std::string Describe(const char* what, size_t x, size_t y, int expected, int actual)
+    {
+        std::ostringstream os;
+        os << what << " at (" << x << ", " << y << ") is " << actual << " but should be " << expected;
+        return os.str();
+    }
+
+    // Returns how the pit differs from the reference, or nothing if it doesn't.
+    std::string Compare(const ReferencePit& expected, const Pit& actual)
+    {
+        for (size_t y = 0; y < Pit::rows; y++)
+        {
+            for (size_t x = 0; x < Pit::cols; x++)
+            {
+                if (expected.TileTypeAt(x, y) != actual.TileTypeAt(x, y))
+                {
+                    return Describe("The tile type", x, y, static_cast<int>(expected.TileTypeAt(x, y)), static_cast<int>(actual.TileTypeAt(x, y)));
+                }
+                if (expected.HeightAt(x, y) != actual.HeightAt(x, y))
+                {
+                    return Describe("The height", x, y, expected.HeightAt(x, y), actual.HeightAt(x, y));
+                }
+                if (expected.ChainAt(x, y) != actual.ChainAt(x, y))
+                {
+                    return Describe("The chain", x, y, static_cast<int>(expected.ChainAt(x, y)), actual.ChainAt(x, y));
+                }
+            }
+        }
+        if (expected.IsImpacted() != actual.IsImpacted())
+        {
+            return actual.IsImpacted() ? "The pit impacted but shouldn't have" : "The pit should have impacted";
+        }
+
+        const auto& expectedRuns = expected.Runs();
+        const auto actualRuns = actual.Runs();
+        if (expectedRuns.size() != actualRuns.size())
+        {
+            return "There are " + std::to_string(actualRuns.size()) + " runs but there should be " + std::to_string(expectedRuns.size());
+        }
+        for (size_t i = 0; i < expectedRuns.size(); i++)
+        {
+            const auto& e = expectedRuns[i];
+            const auto a = actualRuns[i];
+            if (e.runSize != a.runSize || e.chainLength != a.chainLength)
+            {
+                return "Run " + std::to_string(i) + " has size " + std::to_string(a.runSize) + " and chain " + std::to_string(a.chainLength)
+                        + " but should have size " + std::to_string(e.runSize) + " and chain " + std::to_string(e.chainLength);
+            }
+
+            // The order of a run's tiles doesn't matter.
+            std::vector<std::pair<uint16_t, uint16_t>> expectedCoords;
+            std::vector<std::pair<uint16_t, uint16_t>> actualCoords;
+            for (size_t j = 0; j < e.runSize; j++)
+            {
+                expectedCoords.emplace_back(static_cast<uint16_t>(e.coord[j].x), static_cast<uint16_t>(e.coord[j].y));
+                actualCoords.emplace_back(a.coord[j].x, a.coord[j].y);
+            }
+            std::sort(expectedCoords.begin(), expectedCoords.end());
+            std::sort(actualCoords.begin(), actualCoords.end());
+            if (expectedCoords != actualCoords)
+            {
+                return "Run " + std::to_string(i) + " has different tiles";
+            }
+        }
+        return {};
+    }
+
+    struct Divergence
+    {
+        uint32_t tick{std::numeric_limits<uint32_t>::max()};// The update after which the pits disagreed.
+        std::string what;
+
+        bool Found() const
+        {
+            return !what.empty();
+        }
+    };
+
+    // Plays a game's moves, stopping at the first disagreement.
+    Divergence Replay(const Game& game)
+    {
+        ReferencePit expected;
+        Pit actual;
+        expected.Reset(game.level, game.seed);
+        actual.Reset(game.level, game.seed);
+        std::string what = Compare(expected, actual);
+        if (!what.empty())
+        {
+            return Divergence{0, what};
+        }
+        for (size_t tick = 0; tick < game.moves.size(); tick++)
+        {
+            Play(expected, game.moves[tick]);
+            Play(actual, game.moves[tick]);
+            what = Compare(expected, actual);
+            if (!what.empty())
+            {
+                return Divergence{static_cast<uint32_t>(tick + 1), what};
+            }
+        }
+        return {};
+    }
+
+    // Plays a game with random moves, without keeping them, until it ends or the pits disagree. Returns the number of
+    // updates played.
+    uint32_t Check(const Options& options, uint64_t i, Divergence& divergence)
+    {
+        Rng rng;
+        const Game game = StartGame(options.seed, i, rng);
+        ReferencePit expected;
+        Pit actual;
+        expected.Reset(game.level, game.seed);
+        actual.Reset(game.level, game.seed);
+        uint32_t tick = 0;
+        for (; tick < options.gameTicks && !expected.IsImpacted(); tick++)
+        {
+            const Move move = RandomMove(rng);
+            Play(expected, move);
+            Play(actual, move);
+            std::string what = Compare(expected, actual);
+            if (!what.empty())
+            {
+                divergence = Divergence{tick + 1, what};
+                return tick + 1;
+            }
+        }
+        return tick;
+    }
+
+    // Plays the i-th game again, keeping its moves up to where it disagreed.
+    Game Regenerate(const Options& options, uint64_t i, uint32_t ticks)
+    {
+        Rng rng;
+        Game game = StartGame(options.seed, i, rng);
+        for (uint32_t tick = 0; tick < ticks; tick++)
+        {
+            game.moves.push_back(RandomMove(rng));
+        }
+        return game;
+    }
+
+    // Takes away as many moves as possible while the pits still disagree, first in large blocks and then one at a
+    // time, and cuts the game off where they disagree.
+    Game Shrink(Game game, Divergence& divergence)
+    {
+        bool shrunk = true;
+        while (shrunk)
+        {
+            shrunk = false;
+            for (size_t block = std::max<size_t>(game.moves.size() / 2, 1); block >= 1; block /= 2)
+            {
+                for (size_t start = 0; start < game.moves.size(); start += block)
+                {
+                    Game trial = game;
+                    bool changed = false;
+                    for (size_t j = start; j < std::min(start + block, trial.moves.size()); j++)
+                    {
+                        changed = changed || !trial.moves[j].IsNone();
+                        trial.moves[j] = Move{};
+                    }
+                    if (!changed)
+                    {
+                        continue;
+                    }
+                    const Divergence trialDivergence = Replay(trial);
+                    if (trialDivergence.Found())
+                    {
+                        trial.moves.resize(trialDivergence.tick);
+                        game = trial;
+                        divergence = trialDivergence;
+                        shrunk = true;
+                    }
+                }
+                if (block == 1)
+                {
+                    break;
+                }
+            }
+        }
+        return game;
+    }
+
+    // Both pits as they stood where they disagreed, the reference on the left, as comments.
+    void WriteBoards(std::ostream& os, const Game& game)
+    {
+        static constexpr char tileChars[] = ".RGYCMB#";
+        ReferencePit expected;
+        Pit actual;
+        expected.Reset(game.level, game.seed);
+        actual.Reset(game.level, game.seed);
+        for (const Move& move : game.moves)
+        {
+            Play(expected, move);
+            Play(actual, move);
+        }
+        for (size_t y = 0; y < Pit::rows; y++)
+        {
+            os << "# ";
+            for (size_t x = 0; x < Pit::cols; x++)
+            {
+                os << tileChars[static_cast<size_t>(expected.TileTypeAt(x, y))];
+            }
+            os << "  ";
+            for (size_t x = 0; x < Pit::cols; x++)
+            {
+                os << tileChars[static_cast<size_t>(actual.TileTypeAt(x, y))];
+            }
+            os << "\n";
+        }
+    }
+
+    void WriteReproducer(std::ostream& os, const Game& game, const Divergence& divergence)
+    {
+        os << "# " << divergence.what << " after update " << divergence.tick << "\n";
+        WriteBoards(os, game);
+        os << "seed " << game.seed << "\n";
+        os << "level " << game.level << "\n";
+        os << "ticks " << game.moves.size() << "\n";
+        for (size_t tick = 0; tick < game.moves.size(); tick++)
+        {
+            const Move& move = game.moves[tick];
+            if (move.scroll)
+            {
+                os << "scroll " << tick << "\n";
+            }
+            if (move.swap)
+            {
+                os << "swap " << tick << " " << int{move.x} << " " << int{move.y} << "\n";
+            }
+            if (move.wall)
+            {
+                os << "wall " << tick << " " << int{move.wallX} << " " << int{move.wallY} << "\n";
+            }
+        }
+    }
+
+    // Throws std::runtime_error if the reproducer is malformed.
+    Game ReadReproducer(std::istream& is)
+    {
+        Game game;
+        for (std::string line; std::getline(is, line);)
+        {
+            std::istringstream words(line);
+            std::string word;
+            if (!(words >> word) || word[0] == '#')
+            {
+                continue;
+            }
+            size_t tick = 0;
+            if (word == "seed")
+            {
+                words >> game.seed;
+            }
+            else if (word == "level")
+            {
+                words >> game.level;
+            }
+            else if (word == "ticks")
+            {
+                words >> tick;
+                game.moves.resize(tick);
+            }
+            else if (word == "scroll" && words >> tick && tick < game.moves.size())
+            {
+                game.moves[tick].scroll = true;
+            }
+            else if (int x = 0, y = 0; word == "swap" && words >> tick >> x >> y && tick < game.moves.size()
+                     && x >= 0 && static_cast<size_t>(x) + 1 < Pit::cols && y >= 0 && static_cast<size_t>(y) < Pit::rows)
+            {
+                game.moves[tick].swap = true;
+                game.moves[tick].x = static_cast<uint8_t>(x);
+                game.moves[tick].y = static_cast<uint8_t>(y);
+            }
+            else if (int x = 0, y = 0; word == "wall" && words >> tick >> x >> y && tick < game.moves.size()
+                     && x >= 0 && static_cast<size_t>(x) < Pit::cols && y >= 0 && static_cast<size_t>(y) < Pit::rows)
+            {
+                game.moves[tick].wall = true;
+                game.moves[tick].wallX = static_cast<uint8_t>(x);
+                game.moves[tick].wallY = static_cast<uint8_t>(y);
+            }
+            else
+            {
+                throw std::runtime_error("Unexpected line: " + line);
+            }
+            if (!words)
+            {
+                throw std::runtime_error("Malformed line: " + line);
+            }
+        }
+        if (game.level < 1 || game.level > Difficulty::maxLevel)
+        {
+            throw std::runtime_error("The level is out of range");
+        }
+        return game;
+    }
+
+    int PlayReproducer(const std::string& filename)
+    {
+        std::ifstream file(filename);
+        if (!file)
+        {
+            std::fprintf(stderr, "Unable to open %s\n", filename.c_str());
+            return EXIT_FAILURE;
+        }
+        try
+        {
+            const Game game = ReadReproducer(file);
+            const Divergence divergence = Replay(game);
+            if (divergence.Found())
+            {
+                std::printf("%s after update %u\n", divergence.what.c_str(), divergence.tick);
+                return EXIT_FAILURE;
+            }
+            std::printf("The pits agree for all %zu updates\n", game.moves.size());
+            return EXIT_SUCCESS;
+        }
+        catch (const std::exception& e)
+        {
+            std::fprintf(stderr, "%s: %s\n", filename.c_str(), e.what());
+            return EXIT_FAILURE;
+        }
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "Usage: %s [--ticks N] [--game-ticks N] [--threads N] [--seed S] | --repro FILE\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!options.repro.empty())
+    {
+        return PlayReproducer(options.repro);
+    }
+
+    // Games are shared out in batches, a round at a time, until enough updates have been played or the pits disagree.
+    // If more than one game disagrees in a round then the first of them is the one that's reported, so the result
+    // doesn't depend on the number of threads.
+    WorkPool pool{options.threads};
+    const uint64_t gamesPerBatch = 16;
+    const uint64_t batchesPerRound = 8 * pool.Workers();
+    std::atomic<uint64_t> ticks{0};
+    std::atomic<bool> stop{false};
+    std::mutex mutex;
+    uint64_t firstGame = std::numeric_limits<uint64_t>::max();
+    Divergence firstDivergence;
+    uint64_t games = 0;
+    const auto start = std::chrono::steady_clock::now();
+    while (ticks.load() < options.ticks && !stop.load())
+    {
+        for (uint64_t batch = 0; batch < batchesPerRound; batch++)
+        {
+            const uint64_t first = games + batch * gamesPerBatch;
+            pool.Submit([&, first](size_t) {
+                uint64_t batchTicks = 0;
+                for (uint64_t i = first; i < first + gamesPerBatch && !stop.load(std::memory_order_relaxed); i++)
+                {
+                    Divergence divergence;
+                    batchTicks += Check(options, i, divergence);
+                    if (divergence.Found())
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (i < firstGame)
+                        {
+                            firstGame = i;
+                            firstDivergence = divergence;
+                        }
+                        stop.store(true);
+                        break;
+                    }
+                }
+                ticks.fetch_add(batchTicks);
+            });
+        }
+        pool.Wait();
+        games += batchesPerRound * gamesPerBatch;
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::fprintf(stderr, "\r%llu updates in %.0fs (%.1fM/s)", static_cast<unsigned long long>(ticks.load()), seconds,
+                     static_cast<double>(ticks.load()) / seconds / 1e6);
+    }
+    std::fprintf(stderr, "\n");
+
+    if (!stop.load())
+    {
+        std::fprintf(stderr, "The pits agreed for %llu updates\n", static_cast<unsigned long long>(ticks.load()));
+        return EXIT_SUCCESS;
+    }
+
+    std::fprintf(stderr, "Game %llu: %s after update %u. Shrinking it...\n", static_cast<unsigned long long>(firstGame),
+                 firstDivergence.what.c_str(), firstDivergence.tick);
+    const Game game = Shrink(Regenerate(options, firstGame, firstDivergence.tick), firstDivergence);
+    WriteReproducer(std::cout, game, firstDivergence);
+    return EXIT_FAILURE;
+}
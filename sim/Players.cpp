@@ -0,0 +1,150 @@
+#include "Players.h"
+
+#include "pit_core/Scoring.h"
+
+#include <cstdlib>
+#include <limits>
+
+namespace
+{
+    // The number of empty tiles below (x, y) before something solid.
+    size_t DropBelow(const Pit& pit, size_t x, size_t y)
+    {
+        size_t drop = 0;
+        for (size_t below = y + 1; below < Pit::rows && pit.TileTypeAt(x, below) == Pit::TileType::None; below++)
+        {
+            ++drop;
+        }
+        return drop;
+    }
+
+    bool IsFalling(const Pit& pit, size_t x, size_t y)
+    {
+        return pit.TileTypeAt(x, y) != Pit::TileType::None && pit.HeightAt(x, y) != 0;
+    }
+
+    // The first row from the top that has a tile in it.
+    size_t TopOfStack(const Pit& pit)
+    {
+        for (size_t y = 0; y < Pit::rows; y++)
+        {
+            for (size_t x = 0; x < Pit::cols; x++)
+            {
+                if (pit.TileTypeAt(x, y) != Pit::TileType::None)
+                {
+                    return y;
+                }
+            }
+        }
+        return Pit::rows;
+    }
+} // namespace
+
+RandomPlayer::RandomPlayer(uint64_t seed, uint32_t period)
+    : rng_{seed}, period_{period}
+{
+}
+
+uint8_t RandomPlayer::Act(const PitGame& /*game*/)
+{
+    if (wait_ > 0)
+    {
+        --wait_;
+        return PitGame::None;
+    }
+    wait_ = period_ - 1;
+    static constexpr uint8_t presses[] = {PitGame::Left, PitGame::Right, PitGame::Up, PitGame::Down, PitGame::Swap, PitGame::Swap};
+    return presses[rng_.Below(sizeof(presses))];
+}
+
+GreedyPlayer::GreedyPlayer(uint64_t seed, uint32_t period)
+    : rng_{seed}, period_{period}
+{
+}
+
+uint8_t GreedyPlayer::Act(const PitGame& game)
+{
+    if (wait_ > 0)
+    {
+        --wait_;
+        return PitGame::None;
+    }
+    wait_ = period_ - 1;
+
+    // Choose again on every press, because the pit may have scrolled or changed since the last one.
+    const Target target = Choose(game);
+    if (!target.found)
+    {
+        // There's nothing worth doing, so bring up more tiles if there's room for them.
+        return TopOfStack(game.GetPit()) > Pit::rows - 4 ? PitGame::Raise : PitGame::None;
+    }
+    if (target.x < game.CursorX())
+    {
+        return PitGame::Left;
+    }
+    if (target.x > game.CursorX())
+    {
+        return PitGame::Right;
+    }
+    if (target.y < game.CursorY())
+    {
+        return PitGame::Up;
+    }
+    if (target.y > game.CursorY())
+    {
+        return PitGame::Down;
+    }
+    return PitGame::Swap;
+}
+
+GreedyPlayer::Target GreedyPlayer::Choose(const PitGame& game)
+{
+    const Pit& pit = game.GetPit();
+    Target best;
+    int64_t bestValue = std::numeric_limits<int64_t>::min();
+    for (size_t y = 1; y < Pit::rows - 1; y++)
+    {
+        for (size_t x = 0; x < Pit::cols - 1; x++)
+        {
+            const auto left = pit.TileTypeAt(x, y);
+            const auto right = pit.TileTypeAt(x + 1, y);
+            if (left == right || left == Pit::TileType::Wall || right == Pit::TileType::Wall
+                || IsFalling(pit, x, y) || IsFalling(pit, x + 1, y))
+            {
+                continue;
+            }
+
+            // Try the swap on a copy of the pit and see what it scores.
+            Pit trial{pit};
+            trial.Swap(x, y);
+            trial.Update();
+            const auto score = static_cast<int64_t>(Scoring::ScoreRuns(trial.Runs()));
+
+            // Otherwise, moving a tile over a gap lets it drop, which flattens the stack.
+            int64_t drop = 0;
+            if (left == Pit::TileType::None)
+            {
+                drop = static_cast<int64_t>(DropBelow(pit, x, y));
+            }
+            else if (right == Pit::TileType::None)
+            {
+                drop = static_cast<int64_t>(DropBelow(pit, x + 1, y));
+            }
+            if (score == 0 && drop == 0)
+            {
+                continue;
+            }
+
+            // Prefer nearby swaps, with a little noise so that ties don't always go the same way.
+            const auto distance = static_cast<int64_t>(std::abs(static_cast<int>(x) - static_cast<int>(game.CursorX()))
+                                                       + std::abs(static_cast<int>(y) - static_cast<int>(game.CursorY())));
+            const int64_t value = score * 1024 + drop * 64 - distance * 4;
+            if (value > bestValue)
+            {
+                bestValue = value;
+                best = Target{x, y, true};
+            }
+        }
+    }
+    return best;
+}
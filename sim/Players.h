@@ -0,0 +1,57 @@
+#pragma once
+
+#include "pit_core/PitGame.h"
+#include "pit_core/Rng.h"
+
+#include <cstdint>
+
+// Something that plays a PitGame, deciding what to do on each update.
+class Player
+{
+public:
+    virtual ~Player() = default;
+
+    // Returns the actions for the next update.
+    virtual uint8_t Act(const PitGame& game) = 0;
+};
+
+// Presses buttons at random, at about the rate that a person can.
+class RandomPlayer : public Player
+{
+public:
+    // Presses a button once every period updates.
+    RandomPlayer(uint64_t seed, uint32_t period);
+
+    uint8_t Act(const PitGame& game) override;
+
+private:
+    Rng rng_;
+    uint32_t period_;
+    uint32_t wait_{0};
+};
+
+// Picks the swap that scores the most straight away, or failing that the one that drops a tile the furthest, then
+// moves the cursor to it one button press at a time. It doesn't look any further ahead, so it's roughly as good as a
+// new player with quick fingers.
+class GreedyPlayer : public Player
+{
+public:
+    // Presses a button once every period updates.
+    GreedyPlayer(uint64_t seed, uint32_t period);
+
+    uint8_t Act(const PitGame& game) override;
+
+private:
+    struct Target
+    {
+        size_t x{0};
+        size_t y{0};
+        bool found{false};
+    };
+
+    Target Choose(const PitGame& game);
+
+    Rng rng_;
+    uint32_t period_;
+    uint32_t wait_{0};
+};
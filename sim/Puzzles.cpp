@@ -0,0 +1,227 @@
+// Generates puzzles that can be cleared in exactly a given number of swaps, and in only one way, using every core.
+//
+// Usage: pit_puzzles [--count N] [--swaps MIN-MAX] [--levels FIRST-LAST] [--threads N] [--seed S]
+//
+// Each candidate is a small stack of tiles on the floor of the pit, drawn with the same colour rules as the rows that
+// refill the pit at its level, then cut down to a random height in each column. Candidates are searched exhaustively
+// to see how many ways there are to clear them, and only those with exactly one way that takes exactly the number of
+// swaps that was asked for are kept. Every candidate gets its own seed, drawn from the seed on the command line and its
+// place in the order, and they are kept in that order, so the pack is the same however many threads made it.
+//
+// The pack is written to stdout, with --count puzzles for each number of swaps in turn, and the rate to stderr.
+
+#include "pit_core/Difficulty.h"
+#include "pit_core/Pit.h"
+#include "pit_core/Puzzle.h"
+#include "pit_core/Rng.h"
+#include "pit_core/WorkPool.h"
+#include "pit_core/Zobrist.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        size_t count{100};
+        size_t minSwaps{1};
+        size_t maxSwaps{3};
+        size_t firstLevel{1};
+        size_t lastLevel{8};
+        size_t threads{0};
+        uint64_t seed{0x30};
+    };
+
+    // Candidates are searched a batch at a time so that every worker has plenty to do but not much more is searched
+    // than is needed.
+    const size_t batchSize = 256;
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+            const char* value = argv[++i];
+            if (arg == "--count")
+            {
+                options.count = std::strtoull(value, nullptr, 10);
+            }
+            else if (arg == "--swaps")
+            {
+                char* end = nullptr;
+                options.minSwaps = std::strtoull(value, &end, 10);
+                options.maxSwaps = (*end == '-') ? std::strtoull(end + 1, nullptr, 10) : options.minSwaps;
+            }
+            else if (arg == "--levels")
+            {
+                char* end = nullptr;
+                options.firstLevel = std::strtoull(value, &end, 10);
+                options.lastLevel = (*end == '-') ? std::strtoull(end + 1, nullptr, 10) : options.firstLevel;
+            }
+            else if (arg == "--threads")
+            {
+                options.threads = std::strtoull(value, nullptr, 10);
+            }
+            else if (arg == "--seed")
+            {
+                options.seed = std::strtoull(value, nullptr, 0);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return options.minSwaps >= 1 && options.minSwaps <= options.maxSwaps && options.firstLevel >= 1
+               && options.firstLevel <= options.lastLevel;
+    }
+
+    // How many rows high a candidate's stack can be. Almost every random stack can't be cleared at all, and taller ones
+    // take longer to search, so these are the heights that gave the most puzzles a minute for each number of swaps.
+    size_t StackHeight(size_t swaps)
+    {
+        return (swaps == 2 || swaps == 3) ? 2 : 3;
+    }
+
+    // Draws a stack of tiles, and checks that it has no colour with too few tiles to make a run. Returns false if the
+    // draw doesn't come to anything.
+    bool Sample(uint64_t seed, size_t level, size_t swaps, Puzzle& puzzle)
+    {
+        Rng rng{seed};
+        Pit::UpcomingRows rows;
+        rows.Reset(rng.Next64(), Difficulty::ColoursForLevel(level));
+
+        // The rows come out from the top down, so the last one is the floor.
+        const size_t height = StackHeight(swaps);
+        const size_t top = Pit::rows - 1 - height;
+        puzzle.level = level;
+        puzzle.tiles.fill(Pit::TileType::None);
+        std::array<size_t, Pit::cols> columnHeights{};
+        for (auto& columnHeight : columnHeights)
+        {
+            columnHeight = static_cast<size_t>(rng.Between(0, static_cast<int>(height)));
+        }
+        for (size_t y = top; y < Pit::rows; y++)
+        {
+            const Pit::TileType* row = rows.Peek();
+            for (size_t x = 0; x < Pit::cols; x++)
+            {
+                if (y == Pit::rows - 1 || y + columnHeights[x] >= Pit::rows - 1)
+                {
+                    puzzle.tiles[x + y * Pit::cols] = row[x];
+                }
+            }
+            rows.Pop();
+        }
+
+        std::array<size_t, static_cast<size_t>(Pit::TileType::Wall) + 1> counts{};
+        for (size_t i = 0; i < Pit::cols * (Pit::rows - 1); i++)
+        {
+            ++counts[static_cast<size_t>(puzzle.tiles[i])];
+        }
+        size_t total = 0;
+        for (const auto tileType : Pit::tileColours)
+        {
+            const size_t count = counts[static_cast<size_t>(tileType)];
+            if (count > 0 && count < 3)
+            {
+                return false;
+            }
+            total += count;
+        }
+        return total >= 3;
+    }
+
+    struct Candidate
+    {
+        Puzzle puzzle;
+        bool valid{false};
+    };
+
+    void Generate(uint64_t seed, size_t level, size_t swaps, PuzzleSolver& solver, Candidate& candidate)
+    {
+        if (!Sample(seed, level, swaps, candidate.puzzle))
+        {
+            return;
+        }
+        const PuzzleSolver::Result result = solver.Solve(candidate.puzzle, swaps);
+        candidate.valid = result.solutions == 1 && result.solution.size() == swaps;
+        candidate.puzzle.solution = result.solution;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "Usage: %s [--count N] [--swaps MIN-MAX] [--levels FIRST-LAST] [--threads N] [--seed S]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    WorkPool pool{options.threads};
+    std::vector<std::unique_ptr<PuzzleSolver>> solvers;
+    for (size_t i = 0; i < pool.Workers(); i++)
+    {
+        solvers.push_back(std::make_unique<PuzzleSolver>());
+    }
+
+    const size_t numLevels = options.lastLevel - options.firstLevel + 1;
+    std::vector<Puzzle> pack;
+    std::unordered_set<uint64_t> seen;// Boards that are already in the pack.
+    Pit pit;
+    size_t searched = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t swaps = options.minSwaps; swaps <= options.maxSwaps; swaps++)
+    {
+        size_t found = 0;
+        for (uint64_t next = 0; found < options.count; next += batchSize)
+        {
+            std::vector<Candidate> batch(batchSize);
+            for (size_t i = 0; i < batchSize; i++)
+            {
+                const uint64_t index = next + i;
+                const uint64_t seed = Zobrist::Mix(options.seed ^ Zobrist::Mix((uint64_t{swaps} << 48u) | index));
+                const size_t level = options.firstLevel + index % numLevels;
+                pool.Submit([&solvers, &batch, i, seed, level, swaps](size_t worker) {
+                    Generate(seed, level, swaps, *solvers[worker], batch[i]);
+                });
+            }
+            pool.Wait();
+            searched += batchSize;
+
+            for (size_t i = 0; i < batchSize && found < options.count; i++)
+            {
+                if (!batch[i].valid)
+                {
+                    continue;
+                }
+                batch[i].puzzle.SetUp(pit);
+                if (seen.insert(pit.Hash()).second)
+                {
+                    pack.push_back(batch[i].puzzle);
+                    ++found;
+                }
+            }
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "# Made by pit_puzzles --count " << options.count << " --swaps " << options.minSwaps << '-' << options.maxSwaps
+              << " --levels " << options.firstLevel << '-' << options.lastLevel << " --seed " << options.seed << '\n';
+    Puzzle::SavePack(std::cout, pack);
+    std::fprintf(stderr, "Found %zu puzzles in %zu candidates on %zu threads in %.2fs (%.0f puzzles/min)\n",
+                 pack.size(), searched, pool.Workers(), seconds, 60.0 * static_cast<double>(pack.size()) / seconds);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,245 @@
+// Plays large numbers of headless games at each level, spread over every core, to see how hard each level is.
+//
+// Usage: pit_sim [--games N] [--levels FIRST-LAST] [--seconds S] [--player greedy|random] [--threads N] [--seed S]
+//
+// Each game is played at a single level until the pit impacts or the time runs out. Every game gets its own seeds for
+// its pit and its player, drawn up front from the seed on the command line, so the results are the same however many
+// threads play them. The results are written as one line of JSON per level, with the survival time, the score, and how
+// often each length of chain and each size of combo came up.
+
+#include "Players.h"
+
+#include "pit_core/PitGame.h"
+#include "pit_core/Rng.h"
+#include "pit_core/WorkPool.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const uint32_t updatesPerSecond = 60;
+
+    // Chains and combos this long or longer share the last bucket.
+    const size_t numBuckets = 16;
+    using Histogram = std::array<uint64_t, numBuckets>;
+
+    struct Options
+    {
+        size_t games{200};
+        size_t firstLevel{1};
+        size_t lastLevel{20};
+        uint32_t seconds{98};
+        std::string player{"greedy"};
+        size_t threads{0};
+        uint64_t seed{0x30};
+    };
+
+    // What happened in every game at a level. Each worker has its own, so that they never share anything while playing.
+    struct LevelStats
+    {
+        std::vector<uint32_t> survival;// In updates.
+        std::vector<uint64_t> scores;
+        Histogram chains{};// Runs by the length of the chain that they were part of.
+        Histogram combos{};// Updates by the number of runs that they removed.
+        size_t survived{0};
+
+        void Merge(const LevelStats& other)
+        {
+            survival.insert(survival.end(), other.survival.begin(), other.survival.end());
+            scores.insert(scores.end(), other.scores.begin(), other.scores.end());
+            for (size_t i = 0; i < numBuckets; i++)
+            {
+                chains[i] += other.chains[i];
+                combos[i] += other.combos[i];
+            }
+            survived += other.survived;
+        }
+    };
+
+    std::unique_ptr<Player> MakePlayer(const std::string& name, uint64_t seed)
+    {
+        // Both players press a button every 6 updates, or 10 times a second.
+        if (name == "random")
+        {
+            return std::make_unique<RandomPlayer>(seed, 6);
+        }
+        return std::make_unique<GreedyPlayer>(seed, 6);
+    }
+
+    void Play(const Options& options, size_t level, uint64_t pitSeed, uint64_t playerSeed, LevelStats& stats)
+    {
+        PitGame game{level, pitSeed};
+        auto player = MakePlayer(options.player, playerSeed);
+        const uint32_t maxTicks = options.seconds * updatesPerSecond;
+        while (!game.IsOver() && game.Ticks() < maxTicks)
+        {
+            game.Update(player->Act(game));
+            const auto runs = game.GetPit().Runs();
+            if (!runs.empty())
+            {
+                ++stats.combos[std::min(runs.size(), numBuckets) - 1];
+                for (const auto& run : runs)
+                {
+                    ++stats.chains[std::min(run.chainLength, numBuckets - 1)];
+                }
+            }
+        }
+        stats.survival.push_back(game.Ticks());
+        stats.scores.push_back(game.Score());
+        stats.survived += game.IsOver() ? 0 : 1;
+    }
+
+    template<typename T>
+    T Percentile(std::vector<T>& values, size_t percent)
+    {
+        if (values.empty())
+        {
+            return T{};
+        }
+        auto nth = values.begin() + static_cast<std::ptrdiff_t>((values.size() - 1) * percent / 100);
+        std::nth_element(values.begin(), nth, values.end());
+        return *nth;
+    }
+
+    template<typename T>
+    double Mean(const std::vector<T>& values)
+    {
+        double sum = 0.0;
+        for (const auto value : values)
+        {
+            sum += static_cast<double>(value);
+        }
+        return values.empty() ? 0.0 : sum / static_cast<double>(values.size());
+    }
+
+    void PrintHistogram(const Histogram& histogram)
+    {
+        std::printf("[");
+        for (size_t i = 0; i < numBuckets; i++)
+        {
+            std::printf(i == 0 ? "%llu" : ",%llu", static_cast<unsigned long long>(histogram[i]));
+        }
+        std::printf("]");
+    }
+
+    void Report(const Options& options, size_t level, LevelStats& stats)
+    {
+        const double toSeconds = 1.0 / updatesPerSecond;
+        const size_t games = stats.survival.size();
+        std::printf("{\"level\":%zu,\"player\":\"%s\",\"games\":%zu,\"survived\":%.4f,", level, options.player.c_str(), games,
+                    games > 0 ? static_cast<double>(stats.survived) / static_cast<double>(games) : 0.0);
+        std::printf("\"survival\":{\"mean\":%.2f,\"p10\":%.2f,\"p50\":%.2f,\"p90\":%.2f},",
+                    Mean(stats.survival) * toSeconds,
+                    Percentile(stats.survival, 10) * toSeconds,
+                    Percentile(stats.survival, 50) * toSeconds,
+                    Percentile(stats.survival, 90) * toSeconds);
+        std::printf("\"score\":{\"mean\":%.1f,\"p10\":%llu,\"p50\":%llu,\"p90\":%llu},",
+                    Mean(stats.scores),
+                    static_cast<unsigned long long>(Percentile(stats.scores, 10)),
+                    static_cast<unsigned long long>(Percentile(stats.scores, 50)),
+                    static_cast<unsigned long long>(Percentile(stats.scores, 90)));
+        std::printf("\"chains\":");
+        PrintHistogram(stats.chains);
+        std::printf(",\"combos\":");
+        PrintHistogram(stats.combos);
+        std::printf("}\n");
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+            const char* value = argv[++i];
+            if (arg == "--games")
+            {
+                options.games = std::strtoull(value, nullptr, 10);
+            }
+            else if (arg == "--levels")
+            {
+                char* end = nullptr;
+                options.firstLevel = std::strtoull(value, &end, 10);
+                options.lastLevel = (*end == '-') ? std::strtoull(end + 1, nullptr, 10) : options.firstLevel;
+            }
+            else if (arg == "--seconds")
+            {
+                options.seconds = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            }
+            else if (arg == "--player")
+            {
+                options.player = value;
+            }
+            else if (arg == "--threads")
+            {
+                options.threads = std::strtoull(value, nullptr, 10);
+            }
+            else if (arg == "--seed")
+            {
+                options.seed = std::strtoull(value, nullptr, 0);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return options.firstLevel >= 1 && options.firstLevel <= options.lastLevel
+               && (options.player == "greedy" || options.player == "random");
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "Usage: %s [--games N] [--levels FIRST-LAST] [--seconds S] [--player greedy|random] [--threads N] [--seed S]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const size_t numLevels = options.lastLevel - options.firstLevel + 1;
+    WorkPool pool{options.threads};
+    std::vector<std::vector<LevelStats>> workerStats(pool.Workers(), std::vector<LevelStats>(numLevels));
+
+    const auto start = std::chrono::steady_clock::now();
+    Rng seeds{options.seed};
+    for (size_t game = 0; game < options.games; game++)
+    {
+        for (size_t i = 0; i < numLevels; i++)
+        {
+            const uint64_t pitSeed = seeds.Next64();
+            const uint64_t playerSeed = seeds.Next64();
+            pool.Submit([&options, &workerStats, i, pitSeed, playerSeed](size_t worker) {
+                Play(options, options.firstLevel + i, pitSeed, playerSeed, workerStats[worker][i]);
+            });
+        }
+    }
+    pool.Wait();
+    const auto end = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < numLevels; i++)
+    {
+        LevelStats stats;
+        for (const auto& perWorker : workerStats)
+        {
+            stats.Merge(perWorker[i]);
+        }
+        Report(options, options.firstLevel + i, stats);
+    }
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::fprintf(stderr, "Played %zu games on %zu threads in %.2fs (%.1f games/s)\n",
+                 options.games * numLevels, pool.Workers(), seconds, static_cast<double>(options.games * numLevels) / seconds);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,148 @@
+// Searches for the best line of play from a pit, using every core, and writes it as a line of JSON.
+//
+// Usage: pit_solve [--board FILE | --level N --seed S] [--goal score|survival] [--depth N] [--width N] [--press N]
+//                  [--threads N]
+//
+// The pit comes from a .pit board, in the same format as the benchmark's corpus, or is a new game at the given level
+// with the given seed. Every move in the line is a swap, or a pause, and the update that it happens on. The line is
+// played back through a fresh copy of the game to check that it gives the same result before it's written.
+
+#include "bench/Board.h"
+#include "pit_core/PitGame.h"
+#include "pit_core/Search.h"
+#include "pit_core/WorkPool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    struct Options
+    {
+        std::string board;
+        size_t level{1};
+        uint64_t seed{0x30};
+        Search::Options search;
+        size_t threads{0};
+    };
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+            const std::string value = argv[++i];
+            if (arg == "--board")
+            {
+                options.board = value;
+            }
+            else if (arg == "--level")
+            {
+                options.level = std::strtoull(value.c_str(), nullptr, 10);
+            }
+            else if (arg == "--seed")
+            {
+                options.seed = std::strtoull(value.c_str(), nullptr, 0);
+            }
+            else if (arg == "--goal" && (value == "score" || value == "survival"))
+            {
+                options.search.goal = (value == "score") ? Search::Goal::Score : Search::Goal::Survival;
+            }
+            else if (arg == "--depth")
+            {
+                options.search.depth = std::strtoull(value.c_str(), nullptr, 10);
+            }
+            else if (arg == "--width")
+            {
+                options.search.beamWidth = std::strtoull(value.c_str(), nullptr, 10);
+            }
+            else if (arg == "--press")
+            {
+                options.search.ticksPerPress = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+            }
+            else if (arg == "--threads")
+            {
+                options.threads = std::strtoull(value.c_str(), nullptr, 10);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return options.level >= 1 && options.search.beamWidth >= 1 && options.search.ticksPerPress >= 1;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "Usage: %s [--board FILE | --level N --seed S] [--goal score|survival] [--depth N] [--width N] [--press N] [--threads N]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        PitGame game{options.level, options.seed};
+        if (!options.board.empty())
+        {
+            const Board board = Board::Load(options.board);
+            game.Reset(board.level, board.seed);
+            board.SetUp(game.GetPit());
+        }
+
+        WorkPool pool{options.threads};
+        const auto start = std::chrono::steady_clock::now();
+        const Search::Result result = Search::Run(game, options.search, &pool);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Check the line by playing it.
+        PitGame check{game};
+        for (const auto& move : result.line)
+        {
+            if (!Search::Play(check, move, options.search.ticksPerPress))
+            {
+                throw std::runtime_error("The best line can't be played back");
+            }
+        }
+        if (check.Score() != result.score || check.Ticks() != result.ticks || check.IsOver() != result.isOver)
+        {
+            throw std::runtime_error("Playing back the best line gives a different result");
+        }
+
+        std::printf("{\"goal\":\"%s\",\"score\":%llu,\"ticks\":%u,\"over\":%s,\"value\":%lld,\"positions\":%zu,\"seconds\":%.3f,\"line\":[",
+                    options.search.goal == Search::Goal::Score ? "score" : "survival",
+                    static_cast<unsigned long long>(result.score), result.ticks, result.isOver ? "true" : "false",
+                    static_cast<long long>(result.value), result.positions, seconds);
+        for (size_t i = 0; i < result.line.size(); i++)
+        {
+            const auto& move = result.line[i];
+            if (move.swap)
+            {
+                std::printf("%s{\"tick\":%u,\"x\":%u,\"y\":%u}", i == 0 ? "" : ",", move.tick, move.x, move.y);
+            }
+            else
+            {
+                std::printf("%s{\"tick\":%u,\"pause\":true}", i == 0 ? "" : ",", move.tick);
+            }
+        }
+        std::printf("]}\n");
+        std::fprintf(stderr, "Looked at %zu positions on %zu threads in %.2fs (%.0f positions/s)\n",
+                     result.positions, pool.Workers(), seconds, static_cast<double>(result.positions) / seconds);
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,549 @@
+// Checks the scores that come with recorded games by playing the recordings back, using every core, before they go on
+// a leaderboard.
+//
+// Usage: pit_verify --check FILE [--threads N]
+//        pit_verify --serve PORT [--threads N]
+//        pit_verify --make N [--level N] [--seed S]
+//
+// A batch of submissions is text, with one submission per line: the score and level that are claimed for a game, then
+// the game's recording, as saved to "replay" by the game, in hex. Each submission is checked by playing its recording
+// back headlessly, and the result is written as a line of JSON, in the same order as the batch.
+//
+// --check checks a batch from a file, or from stdin if FILE is "-". --serve listens for batches on 127.0.0.1, and
+// keeps the best verified score for each level in memory, standing in for the real leaderboard:
+//
+//   POST /verify       takes a batch and returns the results.
+//   GET /leaderboard   returns the best verified score for each level.
+//
+// --make writes a batch of made-up timed games, played by mashing buttons at random, with every tenth claim inflated,
+// for trying the others out.
+//
+// Each submission is checked on its own, with one game and its recording in memory, and recordings and batches are
+// limited in size, so the memory for a batch is bounded however it was made.
+
+#include "pit_core/Difficulty.h"
+#include "pit_core/Recording.h"
+#include "pit_core/Replay.h"
+#include "pit_core/Rng.h"
+#include "pit_core/WorkPool.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // A game can be paused for as long as the player likes, but nobody pauses for an hour.
+    const size_t maxTicks = 60 * 60 * Difficulty::updatesPerSecond;
+
+    // A recording of an hour of frantic button pressing is a few hundred KB, which is twice that in hex.
+    const size_t maxSubmissionSize = 1024 * 1024;
+    const size_t maxBatchSize = 64 * 1024 * 1024;
+
+    // Each client is read on its own thread. One that goes quiet is dropped, and so is one that trickles a request in,
+    // so that it doesn't tie up a thread for long, and clients beyond the limit are turned away.
+    const int clientTimeoutSeconds = 5;
+    const auto maxRequestTime = std::chrono::seconds(60);
+    const size_t maxClients = 64;
+
+    struct Options
+    {
+        std::string check;
+        int port{0};
+        size_t make{0};
+        size_t level{1};
+        uint64_t seed{0x30};
+        size_t threads{0};
+    };
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+            const char* value = argv[++i];
+            if (arg == "--check")
+            {
+                options.check = value;
+            }
+            else if (arg == "--serve")
+            {
+                options.port = std::atoi(value);
+            }
+            else if (arg == "--make")
+            {
+                options.make = std::strtoull(value, nullptr, 10);
+            }
+            else if (arg == "--level")
+            {
+                options.level = std::strtoull(value, nullptr, 10);
+            }
+            else if (arg == "--seed")
+            {
+                options.seed = std::strtoull(value, nullptr, 0);
+            }
+            else if (arg == "--threads")
+            {
+                options.threads = std::strtoull(value, nullptr, 10);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        const int modes = !options.check.empty() + (options.port > 0) + (options.make > 0);
+        return modes == 1 && options.level >= 1 && options.level <= Difficulty::maxLevel;
+    }
+
+    struct Verdict
+    {
+        bool ok{false};
+        std::string error;
+        Replay::Result result;
+    };
+
+    // The best verified score for each level of timed mode, standing in for the real leaderboard.
+    class Leaderboard
+    {
+    public:
+        void Add(const Replay::Result& result)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            uint64_t& best = best_[std::min(result.level, best_.size()) - 1];
+            best = std::max(best, result.score);
+        }
+
+        std::string Json() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::ostringstream os;
+            os << '[';
+            for (size_t i = 0; i < best_.size(); i++)
+            {
+                os << (i == 0 ? "" : ",") << "{\"level\":" << (i + 1) << ",\"score\":" << best_[i] << '}';
+            }
+            os << "]\n";
+            return os.str();
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        std::array<uint64_t, Difficulty::maxLevel + 1> best_{};// A timed game that lasts counts as the next level.
+    };
+
+    int HexDigit(char c)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f')
+        {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F')
+        {
+            return c - 'A' + 10;
+        }
+        throw std::runtime_error("The recording isn't hex");
+    }
+
+    std::string ToHex(const std::string& bytes)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex;
+        hex.reserve(bytes.size() * 2);
+        for (const char c : bytes)
+        {
+            hex += digits[static_cast<unsigned char>(c) >> 4u];
+            hex += digits[static_cast<unsigned char>(c) & 0xfu];
+        }
+        return hex;
+    }
+
+    Verdict Verify(const std::string& line)
+    {
+        Verdict verdict;
+        try
+        {
+            if (line.size() > maxSubmissionSize)
+            {
+                throw std::runtime_error("The submission is too big");
+            }
+            std::istringstream words(line);
+            uint64_t claimedScore = 0;
+            size_t claimedLevel = 0;
+            std::string hex;
+            if (!(words >> claimedScore >> claimedLevel >> hex) || hex.size() % 2 != 0)
+            {
+                throw std::runtime_error("The submission should be a score, a level and a recording");
+            }
+            std::string bytes(hex.size() / 2, '\0');
+            for (size_t i = 0; i < bytes.size(); i++)
+            {
+                bytes[i] = static_cast<char>(HexDigit(hex[2 * i]) * 16 + HexDigit(hex[2 * i + 1]));
+            }
+            hex.clear();
+            std::istringstream is(bytes);
+            const Recording recording = Recording::Load(is);
+            if (static_cast<Replay::Mode>(recording.mode) != Replay::Mode::Timed)
+            {
+                throw std::runtime_error("Only timed games have scores");
+            }
+            verdict.result = Replay::Run(recording, maxTicks);
+            if (!verdict.result.over)
+            {
+                throw std::runtime_error("The game didn't finish");
+            }
+            if (verdict.result.score != claimedScore || verdict.result.level != claimedLevel)
+            {
+                throw std::runtime_error("The game doesn't match the claim");
+            }
+            verdict.ok = true;
+        }
+        catch (const std::exception& e)
+        {
+            verdict.error = e.what();
+        }
+        return verdict;
+    }
+
+    // Escapes the quotes, backslashes and control characters in some text so that it can go in a JSON string.
+    std::string JsonEscape(const std::string& text)
+    {
+        std::string escaped;
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char code[8];
+                std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned int>(c));
+                escaped += code;
+            }
+            else
+            {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    std::string ToJson(size_t index, const Verdict& verdict)
+    {
+        const Replay::Result& result = verdict.result;
+        std::ostringstream os;
+        os << "{\"index\":" << index << ",\"ok\":" << (verdict.ok ? "true" : "false") << ",\"score\":" << result.score
+           << ",\"level\":" << result.level << ",\"ticks\":" << result.ticks;
+        if (!verdict.ok)
+        {
+            os << ",\"error\":\"" << JsonEscape(verdict.error) << '"';
+        }
+        os << "}\n";
+        return os.str();
+    }
+
+    // Checks every submission in a batch, one task each, and returns the results in order.
+    std::string VerifyBatch(WorkPool& pool, const std::string& batch, Leaderboard* leaderboard, size_t& numOk, size_t& numChecked)
+    {
+        std::vector<std::string> lines;
+        std::istringstream is(batch);
+        for (std::string line; std::getline(is, line);)
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            if (!line.empty() && line[0] != '#')
+            {
+                lines.push_back(std::move(line));
+            }
+        }
+
+        std::vector<Verdict> verdicts(lines.size());
+        for (size_t i = 0; i < lines.size(); i++)
+        {
+            pool.Submit([&lines, &verdicts, i](size_t) {
+                verdicts[i] = Verify(lines[i]);
+                lines[i].clear();
+                lines[i].shrink_to_fit();
+            });
+        }
+        pool.Wait();
+
+        std::string results;
+        for (size_t i = 0; i < verdicts.size(); i++)
+        {
+            if (verdicts[i].ok)
+            {
+                ++numOk;
+                if (leaderboard)
+                {
+                    leaderboard->Add(verdicts[i].result);
+                }
+            }
+            results += ToJson(i, verdicts[i]);
+        }
+        numChecked += verdicts.size();
+        return results;
+    }
+
+    // Makes a recording by holding a random button, or none, for a few updates at a time until the time is up.
+    std::string MakeSubmission(uint64_t seed, size_t level, bool inflate)
+    {
+        Rng rng{seed};
+        Recording recording{rng.Next64(), static_cast<uint32_t>(level), static_cast<uint8_t>(Replay::Mode::Timed), 0, {}};
+        const uint16_t buttons[] = {0, 1u << 3u, 1u << 4u, 1u << 5u, 1u << 6u, 1u << 7u};
+        uint16_t last = 0;
+        for (size_t ticks = 0; ticks <= Difficulty::timedModeUpdates;)
+        {
+            const uint16_t next = buttons[rng.Below(sizeof(buttons) / sizeof(buttons[0]))];
+            const uint32_t length = 2 + rng.Below(8);
+            recording.holds.push_back(Recording::Hold{next == last ? uint16_t{0} : next, length});
+            last = recording.holds.back().buttons;
+            ticks += length;
+        }
+
+        const Replay::Result result = Replay::Run(recording, maxTicks);
+        std::ostringstream os;
+        recording.Save(os);
+        return std::to_string(result.score + (inflate ? 10 : 0)) + " " + std::to_string(result.level) + " " + ToHex(os.str()) + "\n";
+    }
+
+    void Respond(int client, const std::string& status, const std::string& body)
+    {
+        const std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: application/json\r\nContent-Length: "
+                + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+        for (size_t sent = 0; sent < response.size();)
+        {
+            const ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0)
+            {
+                return;
+            }
+            sent += static_cast<size_t>(n);
+        }
+    }
+
+    enum class ReadResult
+    {
+        Ok,
+        Malformed,
+        TooBig
+    };
+
+    // Reads a request, giving up if it's malformed, too big, or too slow to arrive. Only as much of HTTP as curl needs
+    // is handled.
+    ReadResult ReadRequest(int client, std::string& method, std::string& path, std::string& body)
+    {
+        std::string request;
+        size_t headerEnd = std::string::npos;
+        size_t contentLength = 0;
+        char buffer[65536];
+        const auto deadline = std::chrono::steady_clock::now() + maxRequestTime;
+        for (;;)
+        {
+            if (headerEnd == std::string::npos)
+            {
+                headerEnd = request.find("\r\n\r\n");
+                if (headerEnd != std::string::npos)
+                {
+                    std::istringstream headers(request.substr(0, headerEnd));
+                    std::string line;
+                    std::getline(headers, line);
+                    std::istringstream requestLine(line);
+                    requestLine >> method >> path;
+                    while (std::getline(headers, line))
+                    {
+                        const size_t colon = line.find(':');
+                        std::string name = line.substr(0, colon);
+                        for (auto& c : name)
+                        {
+                            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                        }
+                        if (colon != std::string::npos && name == "content-length")
+                        {
+                            contentLength = std::strtoull(line.c_str() + colon + 1, nullptr, 10);
+                        }
+                    }
+                    if (contentLength > maxBatchSize)
+                    {
+                        return ReadResult::TooBig;
+                    }
+                    headerEnd += 4;
+                }
+                else if (request.size() > 65536)
+                {
+                    return ReadResult::TooBig;
+                }
+            }
+            if (headerEnd != std::string::npos && request.size() >= headerEnd + contentLength)
+            {
+                body = request.substr(headerEnd, contentLength);
+                return method.empty() || path.empty() ? ReadResult::Malformed : ReadResult::Ok;
+            }
+            const ssize_t n = recv(client, buffer, sizeof(buffer), 0);
+            if (n <= 0 || std::chrono::steady_clock::now() > deadline)
+            {
+                return ReadResult::Malformed;
+            }
+            request.append(buffer, static_cast<size_t>(n));
+        }
+    }
+
+    // Reads a request from a client and answers it. Batches are verified one at a time, each spread over every core.
+    void Handle(int client, WorkPool& pool, Leaderboard& leaderboard, std::mutex& verifying)
+    {
+        std::string method;
+        std::string path;
+        std::string body;
+        const ReadResult read = ReadRequest(client, method, path, body);
+        if (read == ReadResult::TooBig)
+        {
+            Respond(client, "413 Payload Too Large", "{\"error\":\"The request is too big\"}\n");
+        }
+        else if (read == ReadResult::Malformed)
+        {
+            Respond(client, "400 Bad Request", "{\"error\":\"The request is malformed or incomplete\"}\n");
+        }
+        else if (method == "POST" && path == "/verify")
+        {
+            size_t numOk = 0;
+            size_t numChecked = 0;
+            std::unique_lock<std::mutex> lock(verifying);
+            const auto start = std::chrono::steady_clock::now();
+            const std::string results = VerifyBatch(pool, body, &leaderboard, numOk, numChecked);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            lock.unlock();
+            Respond(client, "200 OK", results);
+            std::fprintf(stderr, "Verified %zu of %zu games in %.2fs\n", numOk, numChecked, seconds);
+        }
+        else if (method == "GET" && path == "/leaderboard")
+        {
+            Respond(client, "200 OK", leaderboard.Json());
+        }
+        else
+        {
+            Respond(client, "404 Not Found", "{\"error\":\"Not found\"}\n");
+        }
+    }
+
+    int Serve(WorkPool& pool, int port)
+    {
+        const int listener = socket(AF_INET, SOCK_STREAM, 0);
+        const int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 16) != 0)
+        {
+            std::perror("Unable to listen");
+            return EXIT_FAILURE;
+        }
+        std::fprintf(stderr, "Listening on http://127.0.0.1:%d with %zu threads\n", port, pool.Workers());
+
+        Leaderboard leaderboard;
+        std::mutex verifying;
+        std::atomic<size_t> numClients{0};
+        for (;;)
+        {
+            const int client = accept(listener, nullptr, nullptr);
+            if (client < 0)
+            {
+                continue;
+            }
+            const timeval timeout{clientTimeoutSeconds, 0};
+            setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            if (numClients.fetch_add(1) >= maxClients)
+            {
+                numClients.fetch_sub(1);
+                Respond(client, "503 Service Unavailable", "{\"error\":\"Too many clients\"}\n");
+                close(client);
+                continue;
+            }
+            std::thread([client, &pool, &leaderboard, &verifying, &numClients] {
+                Handle(client, pool, leaderboard, verifying);
+                close(client);
+                numClients.fetch_sub(1);
+            }).detach();
+        }
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr, "Usage: %s --check FILE | --serve PORT | --make N [--level N] [--seed S] [--threads N]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (options.make > 0)
+    {
+        Rng seeds{options.seed};
+        for (size_t i = 0; i < options.make; i++)
+        {
+            std::cout << MakeSubmission(seeds.Next64(), options.level, i % 10 == 9);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    WorkPool pool{options.threads};
+    if (options.port > 0)
+    {
+        return Serve(pool, options.port);
+    }
+
+    std::ifstream file;
+    if (options.check != "-")
+    {
+        file.open(options.check);
+        if (!file)
+        {
+            std::fprintf(stderr, "Unable to open %s\n", options.check.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    std::istream& is = (options.check == "-") ? std::cin : file;
+    std::ostringstream batch;
+    batch << is.rdbuf();
+
+    size_t numOk = 0;
+    size_t numChecked = 0;
+    const auto start = std::chrono::steady_clock::now();
+    std::cout << VerifyBatch(pool, batch.str(), nullptr, numOk, numChecked);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "Verified %zu of %zu games on %zu threads in %.2fs (%.0f games/min)\n",
+                 numOk, numChecked, pool.Workers(), seconds, 60.0 * static_cast<double>(numChecked) / seconds);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,308 @@
+// Plays one side of a versus game against another process over UDP, with a bot at the controls, to try out rollback
+// over a network that's as bad as required. Each side reports how much it had to roll back, and what that cost, as
+// JSON.
+//
+// Usage: pit_versus --player 0|1 --port PORT --peer PORT [--latency MS] [--jitter MS] [--loss P] [--level N]
+//                   [--seed S] [--seconds N] [--delay FRAMES] [--rollback FRAMES]
+//
+// For example, in two terminals, or with the first in the background:
+//
+//   pit_versus --player 0 --port 7000 --peer 7001 --latency 50 --jitter 10 --loss 0.05
+//   pit_versus --player 1 --port 7001 --peer 7000 --latency 50 --jitter 10 --loss 0.05
+//
+// The latency, jitter and loss are added to the packets that each side sends, on top of whatever the network does.
+// Jitter can make packets arrive out of order. Both sides must be given the same level, seed and length of game.
+
+#include "Players.h"
+
+#include "pit_core/Difficulty.h"
+#include "pit_core/Rng.h"
+#include "pit_core/Rollback.h"
+#include "pit_core/Versus.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        size_t player{0};
+        int port{0};
+        int peer{0};
+        double latency{0.0};
+        double jitter{0.0};
+        double loss{0.0};
+        size_t level{1};
+        uint64_t seed{0x30};
+        uint32_t seconds{Difficulty::timedModeUpdates / Difficulty::updatesPerSecond};
+        uint32_t delay{2};
+        uint32_t rollback{8};
+    };
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+            const char* value = argv[++i];
+            if (arg == "--player")
+            {
+                options.player = std::strtoull(value, nullptr, 10);
+            }
+            else if (arg == "--port")
+            {
+                options.port = std::atoi(value);
+            }
+            else if (arg == "--peer")
+            {
+                options.peer = std::atoi(value);
+            }
+            else if (arg == "--latency")
+            {
+                options.latency = std::atof(value);
+            }
+            else if (arg == "--jitter")
+            {
+                options.jitter = std::atof(value);
+            }
+            else if (arg == "--loss")
+            {
+                options.loss = std::atof(value);
+            }
+            else if (arg == "--level")
+            {
+                options.level = std::strtoull(value, nullptr, 10);
+            }
+            else if (arg == "--seed")
+            {
+                options.seed = std::strtoull(value, nullptr, 0);
+            }
+            else if (arg == "--seconds")
+            {
+                options.seconds = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            }
+            else if (arg == "--delay")
+            {
+                options.delay = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            }
+            else if (arg == "--rollback")
+            {
+                options.rollback = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return options.player < Versus::players && options.port > 0 && options.peer > 0 && options.level >= 1
+                && options.level <= Difficulty::maxLevel;
+    }
+
+    // A UDP socket on 127.0.0.1 that makes the network worse on the way out, by holding packets back for a while or
+    // dropping them.
+    class Link
+    {
+    public:
+        explicit Link(const Options& options) : options_{options}, rng_{options.seed ^ (options.player + 1)}
+        {
+            socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+            sockaddr_in address = Address(options.port);
+            if (socket_ < 0 || bind(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+            {
+                std::perror("Unable to open the socket");
+                std::exit(EXIT_FAILURE);
+            }
+            fcntl(socket_, F_SETFL, fcntl(socket_, F_GETFL, 0) | O_NONBLOCK);
+        }
+
+        ~Link()
+        {
+            close(socket_);
+        }
+
+        void Send(std::vector<uint8_t> packet)
+        {
+            ++sent_;
+            if (rng_.Below(1000000) < static_cast<uint32_t>(options_.loss * 1000000.0))
+            {
+                ++dropped_;
+                return;
+            }
+            const double jitter = options_.jitter * (2.0 * rng_.Below(1001) / 1000.0 - 1.0);
+            const double delay = std::max(0.0, options_.latency + jitter);
+            held_.push_back({Clock::now() + std::chrono::microseconds(static_cast<int64_t>(delay * 1000.0)), std::move(packet)});
+        }
+
+        // Sends the packets that have been held back for long enough.
+        void Flush()
+        {
+            const auto now = Clock::now();
+            const sockaddr_in peer = Address(options_.peer);
+            for (auto it = held_.begin(); it != held_.end();)
+            {
+                if (it->due <= now)
+                {
+                    sendto(socket_, it->packet.data(), it->packet.size(), 0, reinterpret_cast<const sockaddr*>(&peer), sizeof(peer));
+                    it = held_.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        // Reads every packet that has arrived.
+        template<typename F>
+        void Receive(F&& read)
+        {
+            uint8_t buffer[1024];
+            for (;;)
+            {
+                const ssize_t size = recv(socket_, buffer, sizeof(buffer), 0);
+                if (size < 0)
+                {
+                    return;
+                }
+                read(buffer, static_cast<size_t>(size));
+            }
+        }
+
+        uint64_t Sent() const
+        {
+            return sent_;
+        }
+
+        uint64_t Dropped() const
+        {
+            return dropped_;
+        }
+
+    private:
+        struct Held
+        {
+            Clock::time_point due;
+            std::vector<uint8_t> packet;
+        };
+
+        static sockaddr_in Address(int port)
+        {
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<uint16_t>(port));
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            return address;
+        }
+
+        const Options& options_;
+        Rng rng_;
+        int socket_{-1};
+        std::vector<Held> held_;
+        uint64_t sent_{0};
+        uint64_t dropped_{0};
+    };
+
+    double Milliseconds(double seconds)
+    {
+        return seconds * 1000.0;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::fprintf(stderr,
+                     "Usage: %s --player 0|1 --port PORT --peer PORT [--latency MS] [--jitter MS] [--loss P] [--level N] "
+                     "[--seed S] [--seconds N] [--delay FRAMES] [--rollback FRAMES]\n",
+                     argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const Versus versus{options.level, options.seed, options.seconds * Difficulty::updatesPerSecond};
+    RollbackSession session{versus, {options.player, options.delay, options.rollback}};
+    // The bots play at different speeds, so that the two games don't mirror each other.
+    GreedyPlayer player{options.seed + options.player, 6 + 3 * static_cast<uint32_t>(options.player)};
+    Link link{options};
+
+    // Run at the game's update rate. Once the game is over, keep sending for a while in case the other side still needs
+    // this side's last actions, and give up if the other side has gone away.
+    const auto frameTime = std::chrono::nanoseconds(1000000000 / Difficulty::updatesPerSecond);
+    const uint32_t lingerFrames = Difficulty::updatesPerSecond;
+    const uint32_t timeoutFrames = 10 * Difficulty::updatesPerSecond;
+    uint64_t waits = 0;
+    uint64_t stalls = 0;
+    uint32_t linger = 0;
+    uint32_t quiet = 0;
+    auto next = Clock::now();
+    while (linger < lingerFrames && quiet < timeoutFrames)
+    {
+        std::this_thread::sleep_until(next);
+        next += frameTime;
+
+        const uint64_t packetsRead = session.GetStats().packetsRead;
+        link.Receive([&session](const uint8_t* data, size_t size) { session.ReadPacket(data, size); });
+        quiet = (session.GetStats().packetsRead == packetsRead) ? quiet + 1 : 0;
+
+        if (session.IsFinished())
+        {
+            ++linger;
+        }
+        else if (session.ShouldWait())
+        {
+            ++waits;
+        }
+        else if (session.CanAdvance())
+        {
+            session.Advance(player.Act(session.Game().Game(options.player)));
+        }
+        else
+        {
+            ++stalls;
+        }
+        link.Send(session.WritePacket());
+        link.Flush();
+    }
+
+    const RollbackSession::Stats& stats = session.GetStats();
+    const Versus& game = session.Game();
+    std::printf("{\"player\":%zu,\"finished\":%s,\"winner\":%d,\"frames\":%u,\"confirmed\":%u,\"hash\":\"%016llx\",",
+                options.player, session.IsFinished() ? "true" : "false", session.Winner(), session.Frame(),
+                session.ConfirmedFrame(), static_cast<unsigned long long>(session.ConfirmedHash()));
+    std::printf("\"scores\":[%llu,%llu],", static_cast<unsigned long long>(game.Game(0).Score()),
+                static_cast<unsigned long long>(game.Game(1).Score()));
+    std::printf("\"rollbacks\":%llu,\"resimulated\":%llu,\"depths\":[", static_cast<unsigned long long>(stats.rollbacks),
+                static_cast<unsigned long long>(stats.resimulatedFrames));
+    for (size_t i = 0; i < stats.depths.size(); i++)
+    {
+        std::printf("%s%llu", i == 0 ? "" : ",", static_cast<unsigned long long>(stats.depths[i]));
+    }
+    const double meanResimulation = stats.rollbacks > 0 ? stats.resimulationSeconds / static_cast<double>(stats.rollbacks) : 0.0;
+    std::printf("],\"meanResimulationMs\":%.4f,\"maxResimulationMs\":%.4f,\"maxAdvanceMs\":%.4f,", Milliseconds(meanResimulation),
+                Milliseconds(stats.maxResimulationSeconds), Milliseconds(stats.maxAdvanceSeconds));
+    std::printf("\"waits\":%llu,\"stalls\":%llu,\"sent\":%llu,\"dropped\":%llu,\"read\":%llu,\"bad\":%llu,\"desyncs\":%llu}\n",
+                static_cast<unsigned long long>(waits), static_cast<unsigned long long>(stalls),
+                static_cast<unsigned long long>(link.Sent()), static_cast<unsigned long long>(link.Dropped()),
+                static_cast<unsigned long long>(stats.packetsRead), static_cast<unsigned long long>(stats.badPackets),
+                static_cast<unsigned long long>(stats.desyncs));
+    return (session.IsFinished() && stats.desyncs == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
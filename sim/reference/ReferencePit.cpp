@@ -1,11 +1,11 @@
-#include "Pit.h"
-
-#include "je/Logger.h"
+#include "ReferencePit.h"
 
 #include <algorithm>
 
 #define TILE_HEIGHT 15
 
+namespace reference
+{
 int Pit::LowerHeight(size_t x, size_t y)
 {
     auto& tile = TileAt(x, y);
@@ -18,20 +18,23 @@ inline void Pit::MoveDown(size_t x, size_t y)
     TileAt(x, y).height = TILE_HEIGHT;
 }
 
-Pit::Pit(std::function<int(int, int)>& rnd)
-    : rnd_{rnd}, impacted_{false}, run_{0}
+Pit::Pit()
+    : impacted_{false}, run_{0}
 {
     std::fill(tiles_.begin(), tiles_.end(), Tile());
+    upcoming_.Reset(0, ColoursForLevel());
 }
 
 void Pit::SetLevel(size_t level)
 {
     level_ = level;
+    upcoming_.SetColours(ColoursForLevel());
 }
 
-void Pit::Reset(size_t level)
+void Pit::Reset(size_t level, uint64_t seed)
 {
     level_ = level;
+    upcoming_.Reset(seed, ColoursForLevel());
     std::fill(tiles_.begin(), tiles_.end(), Tile());
     RefillRows(rows / 2);
     run_ = 0;
@@ -40,50 +43,36 @@ void Pit::Reset(size_t level)
     runInfo_.clear();
 }
 
-void Pit::Refill(size_t row)
+size_t Pit::ColoursForLevel() const
 {
-    const std::array<TileType, 6> pieces = {
-            TileType::Red,
-            TileType::Yellow,
-            TileType::Cyan,
-            TileType::Magenta,
-            TileType::Green,
-            TileType::Blue};
-
-    auto start = PitIndex(0, row);
-    auto end = PitIndex(cols - 1, row);
-    auto above = PitIndex(0, row - 2);
-
-    int lastTile = -1;
-    int maxTile = 0;
     if (level_ <= 3)// Levels 1-3 have 3 tile types.
     {
-        maxTile = 2;
+        return 3;
     }
     else if (level_ <= 8)// Levels 4-8 have 4 tile types.
     {
-        maxTile = 3;
+        return 4;
     }
     else if (level_ <= 15)// Levels 9-15 have 5 tile types.
     {
-        maxTile = 4;
+        return 5;
     }
     else// Levels 16-20 have 6 tile types.
     {
-        maxTile = 5;
+        return 6;
     }
-    for (auto i = start; i <= end; i++, above++)
+}
+
+void Pit::Refill(size_t row)
+{
+    // The row comes from the queue, which keeps adjacent tiles from being the same colour.
+    const TileType* next = upcoming_.Peek();
+    auto start = PitIndex(0, row);
+    for (size_t x = 0; x < cols; x++)
     {
-        // Prevent adjacent tiles from being the same colour.
-        const TileType tileAbove = tiles_[above].tileType;
-        int tile = rnd_(0, maxTile);
-        while (tile == lastTile || pieces[tile] == tileAbove)
-        {
-            tile = rnd_(0, maxTile);
-        }
-        tiles_[i] = Tile(pieces[tile]);
-        lastTile = tile;
+        tiles_[start + x] = Tile(next[x]);
     }
+    upcoming_.Pop();
 }
 
 void Pit::RefillRows(int numRows)
@@ -183,7 +172,7 @@ bool Pit::CheckForAdjacentRunVertically(const size_t x, const size_t y)
     {
         if (TileTypeAt(x, y) == TileTypeAt(x, y + 1) && IsMovableType(x, y) && !IsEmpty(x, y))
         {
-            if (RunAt(x, y) == (run_ && RunAt(x, y + 1) == 0) || (RunAt(x, y) == 0 && RunAt(x, y + 1) == run_))
+            if ((RunAt(x, y) == run_ && RunAt(x, y + 1) == 0) || (RunAt(x, y) == 0 && RunAt(x, y + 1) == run_))
             {
                 foundRun = true;
                 RunAt(x, y) = run_;
@@ -227,7 +216,7 @@ bool Pit::CheckForAdjacentRunHorizontally(const size_t x, const size_t y)
     {
         if (TileTypeAt(x, y) == TileTypeAt(x + 1, y) && IsMovableType(x, y) && !IsEmpty(x, y))
         {
-            if (RunAt(x, y) == (run_ && RunAt(x + 1, y) == 0) || (RunAt(x, y) == 0 && RunAt(x + 1, y) == run_))
+            if ((RunAt(x, y) == run_ && RunAt(x + 1, y) == 0) || (RunAt(x, y) == 0 && RunAt(x + 1, y) == run_))
             {
                 foundRun = true;
                 RunAt(x, y) = run_;
@@ -415,6 +404,7 @@ void Pit::CheckForRuns()
 
 void Pit::RemoveRuns()
 {
+    runInfo_.clear();
     runInfo_.resize(run_ - 1);
 
     // There were no runs detected.
@@ -423,26 +413,6 @@ void Pit::RemoveRuns()
         return;
     }
 
-    // Output some debug to show the pit.
-    LOG("There are " << (run_ - 1) << " runs");
-    for (size_t y = 0; y < rows; y++)
-    {
-        std::string row;
-        for (size_t x = 0; x < cols; x++)
-        {
-            size_t run = RunAt(x, y);
-            if (run > 0)
-            {
-                row += '0' + (char)RunAt(x, y);
-            }
-            else
-            {
-                row += '.';
-            }
-        }
-        LOG(row);
-    }
-
     // Find the maximum chain length for each run.
     for (size_t y = 0; y < rows; y++)
     {
@@ -502,3 +472,4 @@ void Pit::RemoveDeadChains()
         }
     }
 }
+} // namespace reference
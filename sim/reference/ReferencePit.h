@@ -1,26 +1,32 @@
 #pragma once
 
+#include "pit_core/PitTypes.h"
+#include "pit_core/RowQueue.h"
+
 #include <array>
-#include <functional>
+#include <cstdint>
 #include <vector>
 
+// The pit as the game first played it, before any of it was made faster, frozen as the reference that faster pits are
+// checked against. It looks at every square, one at a time, to do everything. It's kept in its own namespace so that it
+// can be linked alongside the real one. Don't change how it plays: fix the pit instead.
+//
+// It differs from the original in these ways, each of which the real pit made first:
+//
+//  - Its bottom row is fed from the same RowQueue as the pit's, so that both pits see the same tiles.
+//  - The checks for tiles next to a run have the precedence fix from when runs were first labelled in a single pass,
+//    so that each run takes its whole group when more than one run forms at once.
+//  - RemoveRuns() forgets the last update's runs, as it has since runs were reported without allocating.
+//  - Tiles can be set, so that walls can be dropped into it, and its chains can be read.
+namespace reference
+{
 class Pit
 {
 public:
     static constexpr size_t cols = 6;
     static constexpr size_t rows = 13;// Note, one more than is visible because of the wraparound.
 
-    enum class TileType
-    {
-        None,
-        Red,
-        Green,
-        Yellow,
-        Cyan,
-        Magenta,
-        Blue,
-        Wall
-    };
+    using TileType = PitTypes::TileType;
 
     struct PitCoord
     {
@@ -79,14 +85,19 @@ public:
     };
 
 public:
-    Pit(std::function<int(int, int)>& rnd);
+    Pit();
 
-    void Reset(size_t level);
+    void Reset(size_t level, uint64_t seed);
     void SetLevel(size_t level);
     void Update();
     void ScrollOne();
     void Swap(size_t x, size_t y);
 
+    void SetTile(size_t x, size_t y, TileType tileType)
+    {
+        TileAt(x, y) = Tile(tileType);
+    }
+
     int HeightAt(size_t x, size_t y) const
     {
         return tiles_[PitIndex(x, y)].height;
@@ -97,6 +108,11 @@ public:
         return tiles_[PitIndex(x, y)].tileType;
     }
 
+    size_t ChainAt(size_t x, size_t y) const
+    {
+        return tiles_[PitIndex(x, y)].chain;
+    }
+
     bool IsImpacted() const
     {
         return impacted_;
@@ -176,6 +192,7 @@ private:
     void RemoveRuns();
     void RemoveDeadChains();
 
+    size_t ColoursForLevel() const;
     void Refill(size_t row);
     void RefillBottomRow();
     void RefillRows(int numRows);
@@ -191,10 +208,11 @@ private:
 
     std::array<Tile, cols * rows> tiles_;
     size_t firstRow_{0};
-    std::function<int(int, int)>& rnd_;
+    RowQueue<cols, rows> upcoming_;
     bool impacted_;
     size_t run_;
     std::vector<RunInfo> runInfo_;
     bool landed_{false};
     size_t level_{1};
 };
+} // namespace reference